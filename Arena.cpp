@@ -0,0 +1,77 @@
+/* Bump allocator with block reuse, finalizers and size-class free lists */
+#include <cstdlib>
+#include <cstring>
+#include "arena.h"
+#include "val.h"
+
+thread_local AllocStats Allocs;
+thread_local Arena* StringPool = nullptr;
+
+Arena::~Arena()
+{
+    RunFinalizers();
+    for (Block& block : blocks)
+        ::operator delete(block.base);
+}
+
+// Move to the next block with room for size bytes, allocating a new one (at least double the last) if none is left
+char* Arena::Grow(size_t size, size_t align)
+{
+    size_t need = size + align;
+    if (cur != nullptr)
+        current++;
+    while (current < blocks.size() && blocks[current].size < need)
+        current++;
+
+    if (current >= blocks.size())
+    {
+        size_t blockSize = blocks.empty() ? firstSize : blocks.back().size * 2;
+        while (blockSize < need)
+            blockSize *= 2;
+        blocks.push_back(Block{ static_cast<char*>(::operator new(blockSize)), blockSize });
+        current = blocks.size() - 1;
+        Allocs.arenaBlocks++;
+        Allocs.arenaBytes += blockSize;
+    }
+
+    cur = blocks[current].base;
+    end = cur + blocks[current].size;
+    return reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(cur) + align - 1) & ~(uintptr_t)(align - 1));
+}
+
+void Arena::RunFinalizers()
+{
+    for (Finalizer* fin = finalizers; fin != nullptr; fin = fin->next)
+        fin->destroy(fin->obj);
+    finalizers = nullptr;
+}
+
+string_view Arena::Copy(string_view text)
+{
+    char* p = static_cast<char*>(Allocate(text.size(), 1));
+    memcpy(p, text.data(), text.size());
+    return string_view(p, text.size());
+}
+
+// Destroy everything allocated so far and rewind to the first block, keeping all blocks for the next use
+void Arena::Reset()
+{
+    RunFinalizers();
+    for (FreeChunk*& list : freeLists)
+        list = nullptr;
+    current = 0;
+    cur = end = nullptr;
+    if (!blocks.empty())
+    {
+        cur = blocks[0].base;
+        end = cur + blocks[0].size;
+    }
+}
+
+size_t Arena::Capacity() const
+{
+    size_t total = 0;
+    for (const Block& block : blocks)
+        total += block.size;
+    return total;
+}
@@ -0,0 +1,500 @@
+/* Bytecode compiler: lowers a parsed SADAL procedure to register VM code */
+#include <map>
+#include <string>
+#include <vector>
+#include "parserInterp.h"
+#include "vm.h"
+#include "interp.h"
+
+// Codegen namespace: emitting into the chunk being compiled, Ctx->Out. Ctx->Inited holds the slots known
+// to have a value on every path reaching the code being emitted, so their CHKINIT can be omitted
+namespace Codegen
+{
+static int Emit(Opcode op, int a, int b, int c, int line)
+{
+    Ctx->Out->code.push_back(Instr{op, (uint32_t)a, (uint32_t)b, (uint32_t)c});
+    Ctx->Out->lines.push_back(line);
+    return (int)Ctx->Out->code.size() - 1;
+}
+
+static int Here()
+{
+    return (int)Ctx->Out->code.size();
+}
+
+static int NewTemp()
+{
+    int reg = Ctx->Top++;
+    if (Ctx->Top > Ctx->Out->nregs)
+        Ctx->Out->nregs = Ctx->Top;
+    return reg;
+}
+
+}
+
+// Key identifying a constant by type and value, so equal literals share one register
+static string ConstKey(const Value& val)
+{
+    ostringstream key;
+    key << val.GetType() << ':';
+    if (val.IsReal())
+        key << hexfloat << val.GetReal();
+    else
+        key << val;
+    return key.str();
+}
+
+static void CollectConsts(ExprNode* expr)
+{
+    if (expr == nullptr)
+        return;
+
+    switch (expr->kind)
+    {
+        case CONST_NODE:
+        {
+            const Value& val = static_cast<ConstNode*>(expr)->val;
+            string key = ConstKey(val);
+            if (Ctx->ConstIndex.find(key) == Ctx->ConstIndex.end())
+            {
+                Ctx->ConstIndex[key] = (int)Ctx->Out->consts.size();
+                Ctx->Out->consts.push_back(val);
+            }
+            break;
+        }
+        case NAME_NODE:
+            CollectConsts(static_cast<NameNode*>(expr)->index1);
+            CollectConsts(static_cast<NameNode*>(expr)->index2);
+            break;
+        case UNARY_NODE:
+            CollectConsts(static_cast<UnaryNode*>(expr)->operand);
+            break;
+        case BINARY_NODE:
+            CollectConsts(static_cast<BinaryNode*>(expr)->left);
+            CollectConsts(static_cast<BinaryNode*>(expr)->right);
+            break;
+        default:
+            break;
+    }
+}
+
+static void CollectConsts(const vector<StmtNode*>& stmts)
+{
+    for (StmtNode* stmt : stmts)
+    {
+        switch (stmt->kind)
+        {
+            case DECL_NODE: CollectConsts(static_cast<DeclNode*>(stmt)->init); break;
+            case ASSIGN_NODE: CollectConsts(static_cast<AssignNode*>(stmt)->expr); break;
+            case PRINT_NODE: CollectConsts(static_cast<PrintNode*>(stmt)->expr); break;
+            case IF_NODE:
+                for (IfArm& arm : static_cast<IfNode*>(stmt)->arms)
+                {
+                    CollectConsts(arm.cond);
+                    CollectConsts(arm.body);
+                }
+                CollectConsts(static_cast<IfNode*>(stmt)->elseBody);
+                break;
+            case WHILE_NODE:
+                CollectConsts(static_cast<WhileNode*>(stmt)->cond);
+                CollectConsts(static_cast<WhileNode*>(stmt)->body);
+                break;
+            case FOR_NODE:
+                CollectConsts(static_cast<ForNode*>(stmt)->low);
+                CollectConsts(static_cast<ForNode*>(stmt)->high);
+                CollectConsts(static_cast<ForNode*>(stmt)->body);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+static Opcode BinaryOpcode(Token op)
+{
+    switch (op)
+    {
+        case PLUS: return OP_ADD;
+        case MINUS: return OP_SUB;
+        case MULT: return OP_MUL;
+        case DIV: return OP_DIV;
+        case MOD: return OP_MOD;
+        case EXP: return OP_EXP;
+        case CONCAT: return OP_CONCAT;
+        case EQ: return OP_EQ;
+        case NEQ: return OP_NEQ;
+        case LTHAN: return OP_LT;
+        case LTE: return OP_LTE;
+        case GTHAN: return OP_GT;
+        case GTE: return OP_GTE;
+        case AND: return OP_AND;
+        default: return OP_OR;
+    }
+}
+
+// Typed opcode for a binary operation the type pass could prove, or the generic opcode. widen is set when
+// one side is an integer and the other a real; the integer must then be converted with ITOR first. Mixed
+// =, /=, <= and > stay generic, since the Value operators do not treat those as numeric comparisons
+static Opcode TypedBinaryOpcode(BinaryNode* binary, bool& widen)
+{
+    Token left = binary->left->type;
+    Token right = binary->right->type;
+    Token op = binary->op;
+    widen = false;
+    if (binary->type == ERR)
+        return BinaryOpcode(op);
+
+    if (left == INT && right == INT)
+    {
+        switch (op)
+        {
+            case PLUS: return OP_IADD;
+            case MINUS: return OP_ISUB;
+            case MULT: return OP_IMUL;
+            case DIV: return OP_IDIV;
+            case MOD: return OP_IMOD;
+            case EQ: return OP_IEQ;
+            case NEQ: return OP_INEQ;
+            case LTHAN: return OP_ILT;
+            case LTE: return OP_ILTE;
+            case GTHAN: return OP_IGT;
+            case GTE: return OP_IGTE;
+            default: return BinaryOpcode(op);
+        }
+    }
+
+    bool mixed = (left == INT && right == FLOAT) || (left == FLOAT && right == INT);
+    if ((left == FLOAT && right == FLOAT) || mixed)
+    {
+        widen = mixed;
+        switch (op)
+        {
+            case PLUS: return OP_RADD;
+            case MINUS: return OP_RSUB;
+            case MULT: return OP_RMUL;
+            case DIV: return OP_RDIV;
+            case LTHAN: return OP_RLT;
+            case GTE: return OP_RGTE;
+            default: break;
+        }
+        if (!mixed)
+        {
+            switch (op)
+            {
+                case EQ: return OP_REQ;
+                case NEQ: return OP_RNEQ;
+                case LTE: return OP_RLTE;
+                case GTHAN: return OP_RGT;
+                default: break;
+            }
+        }
+        widen = false;
+        return BinaryOpcode(op);
+    }
+
+    if (left == BOOL && right == BOOL && (op == AND || op == OR))
+        return op == AND ? OP_BAND : OP_BOR;
+    return BinaryOpcode(op);
+}
+
+// Typed opcode for NOT or a minus sign, or the generic one
+static Opcode TypedUnaryOpcode(UnaryNode* unary)
+{
+    Token operand = unary->operand->type;
+    if (unary->op == NOT)
+        return operand == BOOL ? OP_BNOT : OP_NOT;
+    if (operand == INT)
+        return OP_INEG;
+    return operand == FLOAT ? OP_RNEG : OP_NEG;
+}
+
+// Put the result in dest when one is given, otherwise in a fresh temporary
+static int Target(int dest)
+{
+    return dest >= 0 ? dest : Codegen::NewTemp();
+}
+
+static int MoveTo(int reg, int dest, int line)
+{
+    if (dest < 0 || dest == reg)
+        return reg;
+    Codegen::Emit(OP_MOVE, dest, reg, 0, line);
+    return dest;
+}
+
+// Compile an expression and return the register holding its value. Variables and constants are used in place
+static int CompileExpr(ExprNode* expr, int dest)
+{
+    using namespace Codegen;
+
+    switch (expr->kind)
+    {
+        case CONST_NODE:
+        {
+            int reg = Ctx->Out->ConstBase() + Ctx->ConstIndex[ConstKey(static_cast<ConstNode*>(expr)->val)];
+            return MoveTo(reg, dest, expr->line);
+        }
+        case NAME_NODE:
+        {
+            NameNode* name = static_cast<NameNode*>(expr);
+            int slot = name->slot;
+            if (!Ctx->Inited[slot])
+            {
+                Emit(OP_CHKINIT, slot, 0, 0, name->line);
+                Ctx->Inited[slot] = true;
+            }
+            if (name->index1 == nullptr)
+                return MoveTo(slot, dest, name->line);
+
+            Emit(OP_CHKSTR, slot, 0, 0, name->line);
+            int save = Ctx->Top;
+            int index;
+            Opcode op;
+            if (name->index2 != nullptr)
+            {
+                index = NewTemp();
+                NewTemp();
+                CompileExpr(name->index1, index);
+                CompileExpr(name->index2, index + 1);
+                op = OP_SLICE;
+            }
+            else
+            {
+                index = CompileExpr(name->index1, -1);
+                op = OP_INDEX;
+            }
+            Ctx->Top = save;
+            int target = Target(dest);
+            Emit(op, target, slot, index, name->line);
+            return target;
+        }
+        case UNARY_NODE:
+        {
+            UnaryNode* unary = static_cast<UnaryNode*>(expr);
+            int save = Ctx->Top;
+            int operand = CompileExpr(unary->operand, -1);
+            Ctx->Top = save;
+            int target = Target(dest);
+            Emit(TypedUnaryOpcode(unary), target, operand, 0, unary->line);
+            return target;
+        }
+        case BINARY_NODE:
+        {
+            BinaryNode* binary = static_cast<BinaryNode*>(expr);
+            int save = Ctx->Top;
+            int left = CompileExpr(binary->left, -1);
+            int right = CompileExpr(binary->right, -1);
+            bool widen;
+            Opcode op = TypedBinaryOpcode(binary, widen);
+            if (widen)
+            {
+                int& intSide = (binary->left->type == INT) ? left : right;
+                int real = NewTemp();
+                Emit(OP_ITOR, real, intSide, 0, binary->line);
+                intSide = real;
+            }
+            Ctx->Top = save;
+            int target = Target(dest);
+            Emit(op, target, left, right, binary->line);
+            return target;
+        }
+        default:
+            return Target(dest);
+    }
+}
+
+static void CompileList(const vector<StmtNode*>& stmts);
+
+// Compile IF/ELSIF arms as a chain of conditional jumps, each taken arm jumping past the rest
+static void CompileIf(IfNode* ifNode)
+{
+    using namespace Codegen;
+
+    vector<int> exits;
+    vector<bool> afterFirstCond;
+    for (size_t i = 0; i < ifNode->arms.size(); i++)
+    {
+        IfArm& arm = ifNode->arms[i];
+        int cond = CompileExpr(arm.cond, -1);
+        Ctx->Top = Ctx->Out->TempBase();
+        if (i == 0)
+            afterFirstCond = Ctx->Inited;
+        int skip = Emit(OP_JMPF, cond, 0, i > 0, arm.cond->line);
+
+        vector<bool> condState = Ctx->Inited;
+        CompileList(arm.body);
+        Ctx->Inited = condState;
+
+        if (i + 1 < ifNode->arms.size() || !ifNode->elseBody.empty())
+            exits.push_back(Emit(OP_JMP, 0, 0, 0, ifNode->line));
+        Ctx->Out->code[skip].b = Here();
+    }
+
+    CompileList(ifNode->elseBody);
+    for (int exit : exits)
+        Ctx->Out->code[exit].a = Here();
+
+    Ctx->Inited = afterFirstCond;
+}
+
+// The condition is tested at the top of every iteration. Variables assigned in the body may not be
+// on the first pass, so initialization state after the loop is what it was before it
+static void CompileWhile(WhileNode* loop)
+{
+    using namespace Codegen;
+
+    vector<bool> before = Ctx->Inited;
+    int top = Here();
+    int cond = CompileExpr(loop->cond, -1);
+    Ctx->Top = Ctx->Out->TempBase();
+    int exit = Emit(OP_JMPF, cond, 0, 2, loop->cond->line);
+
+    CompileList(loop->body);
+    Emit(OP_JMP, top, 0, 0, loop->line);
+    Ctx->Out->code[exit].b = Here();
+    Ctx->Inited = before;
+}
+
+// Both bounds are evaluated once into the loop variable and a hidden limit slot. FORPREP checks them
+// and skips an empty range; FORLOOP at the bottom steps the variable and jumps back while below the limit
+static void CompileFor(ForNode* loop)
+{
+    using namespace Codegen;
+
+    vector<bool> before = Ctx->Inited;
+    CompileExpr(loop->low, loop->slot);
+    CompileExpr(loop->high, loop->limitSlot);
+    Ctx->Top = Ctx->Out->TempBase();
+    Ctx->Inited[loop->slot] = true;
+    Ctx->Inited[loop->limitSlot] = true;
+    int prep = Emit(OP_FORPREP, loop->slot, loop->limitSlot, 0, loop->line);
+
+    int body = Here();
+    CompileList(loop->body);
+    Emit(OP_FORLOOP, loop->slot, loop->limitSlot, body, loop->line);
+    Ctx->Out->code[prep].c = Here();
+    Ctx->Inited = before;
+}
+
+static void CompileStmt(StmtNode* stmt)
+{
+    using namespace Codegen;
+
+    switch (stmt->kind)
+    {
+        case DECL_NODE:
+        {
+            DeclNode* decl = static_cast<DeclNode*>(stmt);
+            const vector<int>& slots = decl->slots;
+            if (decl->init == nullptr)
+                break;
+
+            CompileExpr(decl->init, slots[0]);
+            if (decl->init->type != decl->type)
+                Emit(OP_CHKTYPE, slots[0], decl->type, 1, decl->line);
+            for (int slot : slots)
+            {
+                MoveTo(slots[0], slot, decl->line);
+                Ctx->Inited[slot] = true;
+            }
+            break;
+        }
+        case ASSIGN_NODE:
+        {
+            AssignNode* assign = static_cast<AssignNode*>(stmt);
+            int slot = assign->slot;
+            CompileExpr(assign->expr, slot);
+            if (assign->expr->type != assign->type)
+                Emit(OP_CHKTYPE, slot, assign->type, 0, assign->line);
+            Ctx->Inited[slot] = true;
+            break;
+        }
+        case PRINT_NODE:
+        {
+            PrintNode* print = static_cast<PrintNode*>(stmt);
+            int reg = CompileExpr(print->expr, -1);
+            Emit(OP_PRINT, reg, print->newline, 0, print->line);
+            break;
+        }
+        case GET_NODE:
+        {
+            GetNode* get = static_cast<GetNode*>(stmt);
+            int slot = get->slot;
+            Emit(OP_GET, slot, get->type, 0, get->line);
+            if (get->type != ERR)
+                Ctx->Inited[slot] = true;
+            break;
+        }
+        case IF_NODE:
+            CompileIf(static_cast<IfNode*>(stmt));
+            break;
+        case WHILE_NODE:
+            CompileWhile(static_cast<WhileNode*>(stmt));
+            break;
+        case FOR_NODE:
+            CompileFor(static_cast<ForNode*>(stmt));
+            break;
+        default:
+            break;
+    }
+    Ctx->Top = Ctx->Out->TempBase();
+}
+
+static void CompileList(const vector<StmtNode*>& stmts)
+{
+    for (StmtNode* stmt : stmts)
+        CompileStmt(stmt);
+}
+
+// Follow a chain of unconditional jumps to the instruction it finally reaches
+static uint32_t FinalTarget(const Chunk& chunk, uint32_t target)
+{
+    for (size_t hops = 0; hops < chunk.code.size() && chunk.code[target].op == OP_JMP; hops++)
+        target = chunk.code[target].a;
+    return target;
+}
+
+// Retarget every jump past the jumps it lands on. Without this, leaving an arm nested n IFs deep
+// takes n jumps, one per enclosing END IF; a jump that ends at HALT becomes HALT itself
+static void ThreadJumps(Chunk& chunk)
+{
+    for (Instr& instr : chunk.code)
+    {
+        if (instr.op == OP_JMP)
+        {
+            instr.a = FinalTarget(chunk, instr.a);
+            if (chunk.code[instr.a].op == OP_HALT)
+                instr.op = OP_HALT;
+        }
+        else if (instr.op == OP_JMPF)
+            instr.b = FinalTarget(chunk, instr.b);
+        else if (instr.op == OP_FORPREP || instr.op == OP_FORLOOP)
+            instr.c = FinalTarget(chunk, instr.c);
+    }
+}
+
+// Compile a parsed procedure. Variables keep the slots the parser gave them as their registers
+bool CompileProg(ProgNode* prog, Chunk& chunk)
+{
+    using namespace Codegen;
+
+    chunk = Chunk();
+    chunk.name = prog->name;
+    Ctx->Out = &chunk;
+    chunk.varNames = prog->varNames;
+    chunk.varTypes = prog->varTypes;
+    Ctx->ConstIndex.clear();
+    Ctx->Inited.assign(prog->NumSlots(), false);
+    CollectConsts(prog->decls);
+    CollectConsts(prog->body);
+
+    Ctx->Top = chunk.TempBase();
+    chunk.nregs = Ctx->Top;
+    CompileList(prog->decls);
+    CompileList(prog->body);
+    Emit(OP_HALT, 0, 0, 0, 0);
+    ThreadJumps(chunk);
+
+    Ctx->Out = nullptr;
+    return true;
+}
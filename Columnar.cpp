@@ -0,0 +1,769 @@
+/* Columnar engine: every variable a column over a batch of records, every operator a loop over columns */
+#include <algorithm>
+#include <memory>
+#include <cmath>
+#include <cstring>
+#include "treeInterp.h"
+#include "interp.h"
+#include "columnar.h"
+
+// The kernels are built for AVX2 as well as the baseline on x86-64, the copy to run chosen when the program
+// starts; the baseline has no vector comparison of reals giving a byte per record
+#if defined(__x86_64__) && defined(__GNUC__)
+#define COLUMN_KERNELS __attribute__((target_clones("avx2", "default")))
+#else
+#define COLUMN_KERNELS
+#endif
+
+static int Pool(Token type)
+{
+    return type == INT ? 0 : (type == FLOAT ? 1 : 2);
+}
+
+static bool IsNumber(Token type)
+{
+    return type == INT || type == FLOAT;
+}
+
+// Constants of one type with the same bits; 0.0 and -0.0 differ
+static bool SameConst(const Value& a, const Value& b)
+{
+    if (a.IsInt())
+        return a.GetInt() == b.GetInt();
+    if (a.IsBool())
+        return a.GetBool() == b.GetBool();
+    double x = a.GetReal(), y = b.GetReal();
+    return memcmp(&x, &y, sizeof(double)) == 0;
+}
+
+// Translates statements and expressions to column form, tracking which variables are certain to be assigned
+class ColumnBuilder
+{
+    ProgNode* prog;
+    ColumnarProgram& out;
+    vector<ColReg> vars;
+    vector<bool> assigned;
+    int temps[3] = {};
+    int depth = 0;
+
+public:
+    string reason;
+
+    ColumnBuilder(ProgNode* prog, ColumnarProgram& out)
+        : prog(prog), out(out), vars(prog->NumSlots()), assigned(prog->NumSlots(), false) {}
+
+    bool Fail(int line, const string& why)
+    {
+        reason = "line " + to_string(line) + ": " + why;
+        return false;
+    }
+
+    // The column of a variable, given one on first use
+    ColReg Var(int slot)
+    {
+        if (vars[slot].type == ERR)
+        {
+            Token type = prog->varTypes[slot];
+            vars[slot] = ColReg{ type, false, (uint16_t)out.vars[Pool(type)]++ };
+        }
+        return vars[slot];
+    }
+
+    ColReg Temp(Token type)
+    {
+        int& next = temps[Pool(type)];
+        ColReg reg{ type, true, (uint16_t)next++ };
+        out.temps[Pool(type)] = max(out.temps[Pool(type)], next);
+        return reg;
+    }
+
+    // Equal constants share a column, keeping the columns a batch touches few
+    ColReg Const(const Value& val)
+    {
+        Token type = val.IsInt() ? INT : (val.IsReal() ? FLOAT : BOOL);
+        for (auto& [reg, known] : out.consts)
+        {
+            if (reg.type == type && SameConst(known, val))
+                return reg;
+        }
+        ColReg reg{ type, false, (uint16_t)out.vars[Pool(type)]++ };
+        out.consts.push_back({ reg, val });
+        return reg;
+    }
+
+    // Temporaries live for one statement, or one condition
+    void Release() { temps[0] = temps[1] = temps[2] = 0; }
+
+    ColReg Emit(vector<ColOp>& code, ColOpcode op, Token type, ColReg a, ColReg b = ColReg())
+    {
+        ColReg dst = Temp(type);
+        code.push_back(ColOp{ op, dst, a, b });
+        return dst;
+    }
+
+    ColReg Real(vector<ColOp>& code, ColReg reg)
+    {
+        return reg.type == INT ? Emit(code, COL_I2F, FLOAT, reg) : reg;
+    }
+
+    bool Expr(ExprNode* expr, vector<ColOp>& code, ColReg& result);
+    bool Binary(BinaryNode* binary, vector<ColOp>& code, ColReg& result);
+    bool Stmt(StmtNode* stmt, vector<ColStmt>& stmts);
+    bool List(const vector<StmtNode*>& stmts, vector<ColStmt>& out);
+    bool Cond(ExprNode* cond, ColStmt& stmt);
+};
+
+bool ColumnBuilder::Expr(ExprNode* expr, vector<ColOp>& code, ColReg& result)
+{
+    switch (expr->kind)
+    {
+        case CONST_NODE:
+        {
+            const Value& val = static_cast<ConstNode*>(expr)->val;
+            if (!val.IsInt() && !val.IsReal() && !val.IsBool())
+                return Fail(expr->line, "string or character value");
+            result = Const(val);
+            return true;
+        }
+        case NAME_NODE:
+        {
+            NameNode* name = static_cast<NameNode*>(expr);
+            const string& var = prog->varNames[name->slot];
+            Token type = prog->varTypes[name->slot];
+            if (name->index1 != nullptr || (type != INT && type != FLOAT && type != BOOL))
+                return Fail(expr->line, "string or character variable " + var);
+            if (!assigned[name->slot])
+                return Fail(expr->line, "may read " + var + " before it is assigned");
+            result = Var(name->slot);
+            return true;
+        }
+        case UNARY_NODE:
+        {
+            UnaryNode* unary = static_cast<UnaryNode*>(expr);
+            ColReg operand;
+            if (!Expr(unary->operand, code, operand))
+                return false;
+            if (unary->op == NOT && operand.type == BOOL)
+                result = Emit(code, COL_NOT, BOOL, operand);
+            else if (unary->op == MINUS && IsNumber(operand.type))
+                result = Emit(code, operand.type == INT ? COL_NEGI : COL_NEGF, operand.type, operand);
+            else
+                return Fail(expr->line, "operand of the wrong type");
+            return true;
+        }
+        case BINARY_NODE:
+            return Binary(static_cast<BinaryNode*>(expr), code, result);
+        default:
+            return Fail(expr->line, "unknown expression");
+    }
+}
+
+// Operators follow the Value operators in val.h. A divisor is not required to be a constant, as it is for a
+// typed instruction: a record dividing by zero fails alone. A comparison of an integer with a real is false
+// for = and, since <= and > are built on < and =, <= is < and > is >= there
+bool ColumnBuilder::Binary(BinaryNode* binary, vector<ColOp>& code, ColReg& result)
+{
+    ColReg a, b;
+    if (!Expr(binary->left, code, a) || !Expr(binary->right, code, b))
+        return false;
+
+    bool numbers = IsNumber(a.type) && IsNumber(b.type);
+    bool ints = a.type == INT && b.type == INT;
+    switch (binary->op)
+    {
+        case PLUS: case MINUS: case MULT: case DIV:
+        {
+            if (!numbers)
+                break;
+            static const ColOpcode intOps[] = { COL_ADDI, COL_SUBI, COL_MULI, COL_DIVI };
+            static const ColOpcode realOps[] = { COL_ADDF, COL_SUBF, COL_MULF, COL_DIVF };
+            int which = binary->op == PLUS ? 0 : (binary->op == MINUS ? 1 : (binary->op == MULT ? 2 : 3));
+            if (ints)
+                result = Emit(code, intOps[which], INT, a, b);
+            else
+                result = Emit(code, realOps[which], FLOAT, Real(code, a), Real(code, b));
+            return true;
+        }
+        case MOD:
+            if (!ints)
+                break;
+            result = Emit(code, COL_MODI, INT, a, b);
+            return true;
+        case EXP:
+            if (!numbers)
+                break;
+            result = Emit(code, COL_POWF, FLOAT, Real(code, a), Real(code, b));
+            return true;
+        case EQ: case NEQ:
+            if (a.type != b.type)
+                result = Const(Value(binary->op == NEQ));
+            else if (a.type == INT)
+                result = Emit(code, binary->op == EQ ? COL_EQI : COL_NEI, BOOL, a, b);
+            else if (a.type == FLOAT)
+                result = Emit(code, binary->op == EQ ? COL_EQF : COL_NEF, BOOL, a, b);
+            else
+                result = Emit(code, binary->op == EQ ? COL_EQB : COL_NEB, BOOL, a, b);
+            return true;
+        case LTHAN: case LTE: case GTHAN: case GTE:
+        {
+            if (!numbers)
+                break;
+            int which = binary->op == LTHAN ? 0 : (binary->op == LTE ? 1 : (binary->op == GTHAN ? 2 : 3));
+            static const ColOpcode intOps[] = { COL_LTI, COL_LEI, COL_GTI, COL_GEI };
+            static const ColOpcode realOps[] = { COL_LTF, COL_LEF, COL_GTF, COL_GEF };
+            static const ColOpcode mixedOps[] = { COL_LTF, COL_LTF, COL_GEF, COL_GEF };
+            if (ints)
+                result = Emit(code, intOps[which], BOOL, a, b);
+            else if (a.type == b.type)
+                result = Emit(code, realOps[which], BOOL, a, b);
+            else
+                result = Emit(code, mixedOps[which], BOOL, Real(code, a), Real(code, b));
+            return true;
+        }
+        case AND: case OR:
+            if (a.type != BOOL || b.type != BOOL)
+                break;
+            result = Emit(code, binary->op == AND ? COL_AND : COL_OR, BOOL, a, b);
+            return true;
+        default:
+            break;
+    }
+    return Fail(binary->line, "operator without a column form for its operands");
+}
+
+// A boolean condition into stmt's code and value
+bool ColumnBuilder::Cond(ExprNode* cond, ColStmt& stmt)
+{
+    Release();
+    if (!Expr(cond, stmt.code, stmt.value))
+        return false;
+    if (stmt.value.type != BOOL)
+        return Fail(cond->line, "condition is not boolean");
+    return true;
+}
+
+bool ColumnBuilder::List(const vector<StmtNode*>& stmts, vector<ColStmt>& out)
+{
+    for (StmtNode* stmt : stmts)
+    {
+        if (!Stmt(stmt, out))
+            return false;
+    }
+    return true;
+}
+
+// A variable assigned in a branch or loop body is certain to be assigned after it only when every IF arm and
+// the ELSE part assign it; a loop body may not run at all
+bool ColumnBuilder::Stmt(StmtNode* node, vector<ColStmt>& stmts)
+{
+    ColStmt stmt;
+    stmt.kind = node->kind;
+    Release();
+
+    switch (node->kind)
+    {
+        case DECL_NODE: case ASSIGN_NODE:
+        {
+            bool decl = node->kind == DECL_NODE;
+            Token type = decl ? static_cast<DeclNode*>(node)->type : static_cast<AssignNode*>(node)->type;
+            ExprNode* expr = decl ? static_cast<DeclNode*>(node)->init : static_cast<AssignNode*>(node)->expr;
+            vector<int> slots = decl ? static_cast<DeclNode*>(node)->slots : vector<int>{ static_cast<AssignNode*>(node)->slot };
+            if (expr == nullptr)
+                return true;
+            if (!Expr(expr, stmt.code, stmt.value))
+                return false;
+            if (stmt.value.type != type)
+                return Fail(node->line, "assignment of a value of another type");
+            for (int slot : slots)
+            {
+                stmt.targets.push_back(Var(slot));
+                assigned[slot] = true;
+            }
+            break;
+        }
+        case PRINT_NODE:
+        {
+            PrintNode* print = static_cast<PrintNode*>(node);
+            stmt.newline = print->newline;
+            const Value* literal = print->expr->kind == CONST_NODE ? &static_cast<ConstNode*>(print->expr)->val : nullptr;
+            if (literal != nullptr && literal->IsString())
+                stmt.text = string(literal->GetString());
+            else if (literal != nullptr && literal->IsChar())
+                stmt.text = string(1, literal->GetChar());
+            else if (!Expr(print->expr, stmt.code, stmt.value))
+                return false;
+            break;
+        }
+        case GET_NODE:
+        {
+            GetNode* get = static_cast<GetNode*>(node);
+            if (get->type != INT && get->type != FLOAT && get->type != BOOL)
+                return Fail(node->line, "GET of a string or character variable");
+            stmt.targets.push_back(Var(get->slot));
+            assigned[get->slot] = true;
+            break;
+        }
+        case IF_NODE:
+        {
+            IfNode* ifNode = static_cast<IfNode*>(node);
+            vector<bool> before = assigned, after(assigned.size(), true);
+            depth++;
+            auto branch = [&](const vector<StmtNode*>& body, vector<ColStmt>& out)
+            {
+                assigned = before;
+                if (!List(body, out))
+                    return false;
+                for (size_t slot = 0; slot < after.size(); slot++)
+                    after[slot] = after[slot] && assigned[slot];
+                return true;
+            };
+            for (IfArm& arm : ifNode->arms)
+            {
+                ColStmt armStmt;
+                armStmt.kind = IF_NODE;
+                if (!Cond(arm.cond, armStmt) || !branch(arm.body, armStmt.body))
+                    return false;
+                stmt.arms.push_back(move(armStmt));
+            }
+            if (!branch(ifNode->elseBody, stmt.body))
+                return false;
+            out.depth = max(out.depth, depth--);
+            assigned = after;
+            break;
+        }
+        case WHILE_NODE:
+        {
+            WhileNode* loop = static_cast<WhileNode*>(node);
+            vector<bool> before = assigned;
+            depth++;
+            if (!Cond(loop->cond, stmt) || !List(loop->body, stmt.body))
+                return false;
+            out.depth = max(out.depth, depth--);
+            assigned = before;
+            break;
+        }
+        case FOR_NODE:
+        {
+            ForNode* loop = static_cast<ForNode*>(node);
+            if (!Expr(loop->low, stmt.code, stmt.value) || !Expr(loop->high, stmt.code, stmt.limit))
+                return false;
+            if (stmt.value.type != INT || stmt.limit.type != INT)
+                return Fail(node->line, "non-integer bounds in a FOR loop range");
+            stmt.targets = { Var(loop->slot), Var(loop->limitSlot) };
+
+            vector<bool> before = assigned;
+            assigned[loop->slot] = true;
+            depth++;
+            if (!List(loop->body, stmt.body))
+                return false;
+            out.depth = max(out.depth, depth--);
+            assigned = before;
+            break;
+        }
+        default:
+            return Fail(node->line, "unknown statement");
+    }
+
+    stmts.push_back(move(stmt));
+    return true;
+}
+
+bool BuildColumnar(ProgNode* prog, ColumnarProgram& columnar, string& reason)
+{
+    columnar = ColumnarProgram();
+    ColumnBuilder builder(prog, columnar);
+    if (!builder.List(prog->decls, columnar.stmts) || !builder.List(prog->body, columnar.stmts))
+    {
+        reason = builder.reason;
+        return false;
+    }
+    return true;
+}
+
+// Kernels. Each runs over a whole column, active records or not, so the loops have no branches for the
+// compiler to keep it from vectorizing them. Only division and GET can fail, and only for records in the mask
+
+template <class T, class A, class F>
+static void Map(T* dst, const A* a, F f)
+{
+    for (int i = 0; i < ColumnRows; i++)
+        dst[i] = f(a[i]);
+}
+
+template <class T, class A, class F>
+static void Map(T* dst, const A* a, const A* b, F f)
+{
+    for (int i = 0; i < ColumnRows; i++)
+        dst[i] = f(a[i], b[i]);
+}
+
+// Integer quotient or remainder, wrapping as IntDiv and IntMod do; a zero divisor fails the record
+template <bool Mod>
+static void DivideInts(int32_t* dst, const int32_t* a, const int32_t* b, const uint8_t* mask, uint8_t* failed)
+{
+    for (int i = 0; i < ColumnRows; i++)
+    {
+        bool zero = b[i] == 0;
+        failed[i] |= zero & mask[i];
+        int32_t d = zero ? 1 : b[i];
+        dst[i] = Mod ? IntMod(a[i], d) : IntDiv(a[i], d);
+    }
+}
+
+static void DivideReals(double* dst, const double* a, const double* b, const uint8_t* mask, uint8_t* failed)
+{
+    for (int i = 0; i < ColumnRows; i++)
+    {
+        failed[i] |= (b[i] == 0.0) & mask[i];
+        dst[i] = a[i] / b[i];
+    }
+}
+
+static bool Any(const uint8_t* mask)
+{
+    uint8_t any = 0;
+    for (int i = 0; i < ColumnRows; i++)
+        any |= mask[i];
+    return any != 0;
+}
+
+// Set the records of dst in mask to src
+template <class T>
+static void Blend(T* dst, const T* src, const uint8_t* mask)
+{
+    for (int i = 0; i < ColumnRows; i++)
+    {
+        T from = src[i], kept = dst[i];
+        dst[i] = mask[i] ? from : kept;
+    }
+}
+
+// Next whitespace-separated word of a record, as InputSource::Next reads it
+static string_view NextWord(string_view& rest)
+{
+    auto space = [](char c) { return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\f' || c == '\v'; };
+    size_t start = 0;
+    while (start < rest.size() && space(rest[start]))
+        start++;
+    size_t stop = start;
+    while (stop < rest.size() && !space(rest[stop]))
+        stop++;
+    string_view word = rest.substr(start, stop - start);
+    rest.remove_prefix(stop);
+    return word;
+}
+
+// Columns and per-record state of a batch: the unread fields of each record, whether its run has failed,
+// its output so far, and a mask and the records left for the next IF arm at each nesting level
+class ColumnFrame
+{
+    const ColumnarProgram& prog;
+    vector<int32_t> ints;
+    vector<double> reals;
+    vector<uint8_t> bools;
+    vector<uint8_t> masks;
+
+    template <class T>
+    static T* Column(vector<T>& pool, int vars, ColReg reg)
+    {
+        return &pool[(size_t)(reg.temp ? vars + reg.index : reg.index) * ColumnRows];
+    }
+
+    int32_t* Ints(ColReg reg) { return Column(ints, prog.vars[0], reg); }
+    double* Reals(ColReg reg) { return Column(reals, prog.vars[1], reg); }
+    uint8_t* Bools(ColReg reg) { return Column(bools, prog.vars[2], reg); }
+    uint8_t* Mask(int level) { return &masks[(size_t)2 * level * ColumnRows]; }
+    uint8_t* Rest(int level) { return &masks[(size_t)(2 * level + 1) * ColumnRows]; }
+
+    void Eval(const vector<ColOp>& code, const uint8_t* mask);
+    void Assign(ColReg dst, ColReg src, const uint8_t* mask);
+    void Print(const ColStmt& stmt, const uint8_t* mask);
+    void Get(ColReg dst, const uint8_t* mask);
+    void If(const ColStmt& stmt, int level);
+    void While(const ColStmt& stmt, int level);
+    void For(const ColStmt& stmt, int level);
+
+public:
+    string_view fields[ColumnRows];
+    uint8_t failed[ColumnRows];
+    string output[ColumnRows];
+
+    explicit ColumnFrame(const ColumnarProgram& prog);
+
+    void Exec(const vector<ColStmt>& stmts, int level);
+
+    // Start a batch of the first rows records
+    void Begin(int rows)
+    {
+        uint8_t* all = Mask(0);
+        for (int i = 0; i < ColumnRows; i++)
+        {
+            all[i] = i < rows;
+            failed[i] = 0;
+        }
+    }
+};
+
+ColumnFrame::ColumnFrame(const ColumnarProgram& prog)
+    : prog(prog),
+      ints((size_t)(prog.vars[0] + prog.temps[0]) * ColumnRows),
+      reals((size_t)(prog.vars[1] + prog.temps[1]) * ColumnRows),
+      bools((size_t)(prog.vars[2] + prog.temps[2]) * ColumnRows),
+      masks((size_t)2 * (prog.depth + 1) * ColumnRows)
+{
+    for (auto& [reg, val] : prog.consts)
+    {
+        if (reg.type == INT)
+            fill_n(Ints(reg), ColumnRows, val.GetInt());
+        else if (reg.type == FLOAT)
+            fill_n(Reals(reg), ColumnRows, val.GetReal());
+        else
+            fill_n(Bools(reg), ColumnRows, val.GetBool());
+    }
+}
+
+COLUMN_KERNELS void ColumnFrame::Eval(const vector<ColOp>& code, const uint8_t* mask)
+{
+    for (const ColOp& I : code)
+    {
+        switch (I.op)
+        {
+            case COL_ADDI: Map(Ints(I.dst), Ints(I.a), Ints(I.b), [](int32_t x, int32_t y) { return IntAdd(x, y); }); break;
+            case COL_SUBI: Map(Ints(I.dst), Ints(I.a), Ints(I.b), [](int32_t x, int32_t y) { return IntSub(x, y); }); break;
+            case COL_MULI: Map(Ints(I.dst), Ints(I.a), Ints(I.b), [](int32_t x, int32_t y) { return IntMul(x, y); }); break;
+            case COL_DIVI: DivideInts<false>(Ints(I.dst), Ints(I.a), Ints(I.b), mask, failed); break;
+            case COL_MODI: DivideInts<true>(Ints(I.dst), Ints(I.a), Ints(I.b), mask, failed); break;
+            case COL_NEGI: Map(Ints(I.dst), Ints(I.a), [](int32_t x) { return IntNeg(x); }); break;
+            case COL_I2F: Map(Reals(I.dst), Ints(I.a), [](int32_t x) { return (double)x; }); break;
+            case COL_ADDF: Map(Reals(I.dst), Reals(I.a), Reals(I.b), [](double x, double y) { return x + y; }); break;
+            case COL_SUBF: Map(Reals(I.dst), Reals(I.a), Reals(I.b), [](double x, double y) { return x - y; }); break;
+            case COL_MULF: Map(Reals(I.dst), Reals(I.a), Reals(I.b), [](double x, double y) { return x * y; }); break;
+            case COL_DIVF: DivideReals(Reals(I.dst), Reals(I.a), Reals(I.b), mask, failed); break;
+            case COL_NEGF: Map(Reals(I.dst), Reals(I.a), [](double x) { return -x; }); break;
+            case COL_POWF: Map(Reals(I.dst), Reals(I.a), Reals(I.b), [](double x, double y) { return pow(x, y); }); break;
+            case COL_EQI: Map(Bools(I.dst), Ints(I.a), Ints(I.b), [](int32_t x, int32_t y) -> uint8_t { return x == y; }); break;
+            case COL_NEI: Map(Bools(I.dst), Ints(I.a), Ints(I.b), [](int32_t x, int32_t y) -> uint8_t { return x != y; }); break;
+            case COL_LTI: Map(Bools(I.dst), Ints(I.a), Ints(I.b), [](int32_t x, int32_t y) -> uint8_t { return x < y; }); break;
+            case COL_LEI: Map(Bools(I.dst), Ints(I.a), Ints(I.b), [](int32_t x, int32_t y) -> uint8_t { return x <= y; }); break;
+            case COL_GTI: Map(Bools(I.dst), Ints(I.a), Ints(I.b), [](int32_t x, int32_t y) -> uint8_t { return x > y; }); break;
+            case COL_GEI: Map(Bools(I.dst), Ints(I.a), Ints(I.b), [](int32_t x, int32_t y) -> uint8_t { return x >= y; }); break;
+            // Real comparisons keep the NaN behaviour of val.h: > is not <= and >= is not <
+            case COL_EQF: Map(Bools(I.dst), Reals(I.a), Reals(I.b), [](double x, double y) -> uint8_t { return x == y; }); break;
+            case COL_NEF: Map(Bools(I.dst), Reals(I.a), Reals(I.b), [](double x, double y) -> uint8_t { return !(x == y); }); break;
+            case COL_LTF: Map(Bools(I.dst), Reals(I.a), Reals(I.b), [](double x, double y) -> uint8_t { return x < y; }); break;
+            case COL_LEF: Map(Bools(I.dst), Reals(I.a), Reals(I.b), [](double x, double y) -> uint8_t { return x <= y; }); break;
+            case COL_GTF: Map(Bools(I.dst), Reals(I.a), Reals(I.b), [](double x, double y) -> uint8_t { return !(x <= y); }); break;
+            case COL_GEF: Map(Bools(I.dst), Reals(I.a), Reals(I.b), [](double x, double y) -> uint8_t { return !(x < y); }); break;
+            case COL_EQB: Map(Bools(I.dst), Bools(I.a), Bools(I.b), [](uint8_t x, uint8_t y) -> uint8_t { return x == y; }); break;
+            case COL_NEB: Map(Bools(I.dst), Bools(I.a), Bools(I.b), [](uint8_t x, uint8_t y) -> uint8_t { return x ^ y; }); break;
+            case COL_AND: Map(Bools(I.dst), Bools(I.a), Bools(I.b), [](uint8_t x, uint8_t y) -> uint8_t { return x & y; }); break;
+            case COL_OR: Map(Bools(I.dst), Bools(I.a), Bools(I.b), [](uint8_t x, uint8_t y) -> uint8_t { return x | y; }); break;
+            case COL_NOT: Map(Bools(I.dst), Bools(I.a), [](uint8_t x) -> uint8_t { return x ^ 1; }); break;
+        }
+    }
+}
+
+COLUMN_KERNELS void ColumnFrame::Assign(ColReg dst, ColReg src, const uint8_t* mask)
+{
+    if (dst.type == INT)
+        Blend(Ints(dst), Ints(src), mask);
+    else if (dst.type == FLOAT)
+        Blend(Reals(dst), Reals(src), mask);
+    else
+        Blend(Bools(dst), Bools(src), mask);
+}
+
+// Append to the output of each record in mask; a record that has failed will be run again, so it gets none
+void ColumnFrame::Print(const ColStmt& stmt, const uint8_t* mask)
+{
+    char buf[MaxNumberText];
+    for (int i = 0; i < ColumnRows; i++)
+    {
+        if (!mask[i] || failed[i])
+            continue;
+        string& text = output[i];
+        if (stmt.value.type == ERR)
+            text += stmt.text;
+        else if (stmt.value.type == INT)
+            text.append(buf, FormatInt(buf, Ints(stmt.value)[i]) - buf);
+        else if (stmt.value.type == FLOAT)
+            text.append(buf, FormatReal(buf, Reals(stmt.value)[i]) - buf);
+        else
+            text += Bools(stmt.value)[i] ? "true" : "false";
+        if (stmt.newline)
+            text += '\n';
+    }
+}
+
+// Read the next field of each record in mask, as ReadValue does; a field that does not parse fails the record
+void ColumnFrame::Get(ColReg dst, const uint8_t* mask)
+{
+    for (int i = 0; i < ColumnRows; i++)
+    {
+        if (!mask[i] || failed[i])
+            continue;
+        string_view word = NextWord(fields[i]);
+        bool ok;
+        if (dst.type == INT)
+            ok = ParseNumber(word, Ints(dst)[i]);
+        else if (dst.type == FLOAT)
+            ok = ParseNumber(word, Reals(dst)[i]);
+        else
+        {
+            ok = word == "true" || word == "false";
+            Bools(dst)[i] = word == "true";
+        }
+        failed[i] |= !ok;
+    }
+}
+
+// Each arm runs on the records whose earlier conditions were all false and whose own condition is true
+void ColumnFrame::If(const ColStmt& stmt, int level)
+{
+    const uint8_t* mask = Mask(level);
+    uint8_t* rest = Rest(level);
+    uint8_t* inner = Mask(level + 1);
+    for (int i = 0; i < ColumnRows; i++)
+        rest[i] = mask[i] & (failed[i] ^ 1);
+
+    for (const ColStmt& arm : stmt.arms)
+    {
+        Eval(arm.code, rest);
+        const uint8_t* cond = Bools(arm.value);
+        for (int i = 0; i < ColumnRows; i++)
+        {
+            inner[i] = rest[i] & cond[i];
+            rest[i] &= cond[i] ^ 1;
+        }
+        if (Any(inner))
+            Exec(arm.body, level + 1);
+    }
+
+    copy_n(rest, ColumnRows, inner);
+    if (Any(inner))
+        Exec(stmt.body, level + 1);
+}
+
+// Iterate while any record is still in the loop; a record leaves when its condition is false or it fails
+void ColumnFrame::While(const ColStmt& stmt, int level)
+{
+    const uint8_t* mask = Mask(level);
+    uint8_t* inner = Mask(level + 1);
+    for (int i = 0; i < ColumnRows; i++)
+        inner[i] = mask[i] & (failed[i] ^ 1);
+
+    while (true)
+    {
+        Eval(stmt.code, inner);
+        const uint8_t* cond = Bools(stmt.value);
+        for (int i = 0; i < ColumnRows; i++)
+            inner[i] &= cond[i] & (failed[i] ^ 1);
+        if (!Any(inner))
+            break;
+        Exec(stmt.body, level + 1);
+    }
+}
+
+// The loop variable's column counts for every record from its low bound to its high bound
+void ColumnFrame::For(const ColStmt& stmt, int level)
+{
+    const uint8_t* mask = Mask(level);
+    uint8_t* inner = Mask(level + 1);
+    Eval(stmt.code, mask);
+    Assign(stmt.targets[0], stmt.value, mask);
+    Assign(stmt.targets[1], stmt.limit, mask);
+
+    int32_t* var = Ints(stmt.targets[0]);
+    const int32_t* limit = Ints(stmt.targets[1]);
+    for (int i = 0; i < ColumnRows; i++)
+        inner[i] = mask[i] & (failed[i] ^ 1) & (var[i] <= limit[i]);
+
+    while (Any(inner))
+    {
+        Exec(stmt.body, level + 1);
+        for (int i = 0; i < ColumnRows; i++)
+        {
+            inner[i] &= (var[i] != limit[i]) & (failed[i] ^ 1);
+            var[i] += inner[i];
+        }
+    }
+}
+
+void ColumnFrame::Exec(const vector<ColStmt>& stmts, int level)
+{
+    const uint8_t* mask = Mask(level);
+    for (const ColStmt& stmt : stmts)
+    {
+        switch (stmt.kind)
+        {
+            case DECL_NODE: case ASSIGN_NODE:
+                Eval(stmt.code, mask);
+                for (ColReg target : stmt.targets)
+                    Assign(target, stmt.value, mask);
+                break;
+            case PRINT_NODE:
+                Eval(stmt.code, mask);
+                Print(stmt, mask);
+                break;
+            case GET_NODE: Get(stmt.targets[0], mask); break;
+            case IF_NODE: If(stmt, level); break;
+            case WHILE_NODE: While(stmt, level); break;
+            case FOR_NODE: For(stmt, level); break;
+            default: break;
+        }
+    }
+}
+
+// Batches are written out in order as they finish. The records of a batch that failed are run again here,
+// on the bytecode, in their place among the others
+StreamStats RunColumnar(const ColumnarProgram& columnar, const CompiledProgram& prog, string_view input, OutputSink& output)
+{
+    StreamStats stats;
+    if (!prog.ok)
+        return stats;
+
+    Interp ctx;
+    ctx.Sink = &output;
+    InterpScope scope(ctx);
+    auto frame = make_unique<ColumnFrame>(columnar);
+    vector<string_view> records;
+    records.reserve(ColumnRows);
+
+    auto batch = [&]
+    {
+        int rows = (int)records.size();
+        frame->Begin(rows);
+        for (int i = 0; i < rows; i++)
+            frame->fields[i] = records[i];
+        frame->Exec(columnar.stmts, 0);
+
+        for (int i = 0; i < rows; i++)
+        {
+            if (frame->failed[i])
+            {
+                InputSource fields(records[i]);
+                ctx.Input = &fields;
+                if (!RunChunk(prog.chunk, prog.tier.Enter(prog.chunk)))
+                    stats.failed++;
+            }
+            else
+                output << frame->output[i];
+            frame->output[i].clear();
+        }
+        stats.records += rows;
+        records.clear();
+    };
+
+    SplitRecords(input, [&](string_view record)
+    {
+        records.push_back(record);
+        if (records.size() == ColumnRows)
+            batch();
+    });
+    if (!records.empty())
+        batch();
+
+    output.Flush();
+    stats.errors = ctx.error_count;
+    return stats;
+}
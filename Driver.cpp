@@ -0,0 +1,308 @@
+/* Driver program for the SADAL interpreter */
+#include <iostream>
+#include <string>
+#include <fstream>
+#include <memory>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+#include <fcntl.h>
+#include "parserInterp.h"
+#include "treeInterp.h"
+#include "vm.h"
+#include "input.h"
+#include "output.h"
+#include "arena.h"
+#include "profile.h"
+#include "native.h"
+#include "jit.h"
+#include "program.h"
+#include "columnar.h"
+#include "interp.h"
+
+using namespace std;
+
+// Report this thread's allocation counters on stderr, keeping them out of the program's output
+static void PrintAllocStats()
+{
+    cerr << "arena blocks: " << Allocs.arenaBlocks << " (" << Allocs.arenaBytes << " bytes), arena objects: "
+         << Allocs.arenaObjects << ", heap strings: " << Allocs.heapStrings << ", pooled strings: "
+         << Allocs.pooledStrings << endl;
+}
+
+static bool EndsWith(const string& text, const string& suffix)
+{
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// Build a procedure into object, or into a temporary file when there is none, and load it
+static bool LoadNative(ProgNode* prog, const char* object, NativeProgram& native)
+{
+    const char* tmp = getenv("TMPDIR");
+    string path = object != nullptr ? object : string(tmp ? tmp : "/tmp") + "/sadal-" + to_string(getpid()) + ".so";
+    string log;
+    bool loaded = BuildNative(prog, path, log) && native.Load(path, log);
+    if (object == nullptr)
+        remove(path.c_str());
+    // Through StdOut, so the report comes after anything the parse already wrote there
+    if (!loaded)
+    {
+        StdOut << "NATIVE BUILD FAILED\n" << log << '\n';
+        StdOut.Flush();
+    }
+    return loaded;
+}
+
+static void Usage(const char* prog)
+{
+    cout << "Usage: " << prog << " [--tree | --vm | --jit | --native] [--emit-bytecode | --emit-cpp] [--native-out <so>]" << endl
+         << "       [--stream | --batch [--workers <n>] | --columnar] [--alloc-stats] [--input <file>]" << endl
+         << "       [--profile | --profile-json <out>] <file>" << endl
+         << "Profiling runs the tree evaluator and reports statements by source line on stderr, or as JSON" << endl
+         << "--stream runs the procedure once per line of the input, GET reading that line's fields" << endl
+         << "--batch does the same on n worker threads (default one per core), writing the output in input order" << endl
+         << "--columnar does the same a batch of records at a time, each variable a column, for procedures without" << endl
+         << "strings; others run as with --batch" << endl
+         << "--jit runs the VM with its typed instructions compiled to x86-64 machine code" << endl
+         << "--native builds the procedure into a shared object and runs that; --native-out keeps it, and a" << endl
+         << "file ending in .so is such an object, run without parsing" << endl;
+}
+
+int main(int argc, char* argv[])
+{
+    bool useTree = false;
+    bool emitBytecode = false;
+    bool useNative = false;
+    bool useJit = false;
+    bool stream = false;
+    bool batch = false;
+    bool columnar = false;
+    unsigned workers = 0;
+    bool emitCpp = false;
+    const char* nativeOut = nullptr;
+    bool allocStats = false;
+    bool profile = false;
+    const char* profileJson = nullptr;
+    const char* fileName = nullptr;
+    const char* inputName = nullptr;
+
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--tree")
+        {
+            useTree = true;
+            useNative = false;
+        }
+        else if (arg == "--vm")
+            useTree = useNative = false;
+        else if (arg == "--jit")
+        {
+            useTree = useNative = false;
+            useJit = true;
+        }
+        else if (arg == "--stream")
+            stream = true;
+        else if (arg == "--batch")
+            batch = true;
+        else if (arg == "--columnar")
+            batch = columnar = true;
+        else if (arg == "--workers" && i + 1 < argc)
+        {
+            batch = true;
+            workers = (unsigned)atoi(argv[++i]);
+        }
+        else if (arg == "--native")
+        {
+            useTree = false;
+            useNative = true;
+        }
+        else if (arg == "--emit-bytecode")
+            emitBytecode = true;
+        else if (arg == "--emit-cpp")
+            emitCpp = true;
+        else if (arg == "--native-out" && i + 1 < argc)
+        {
+            useTree = false;
+            useNative = true;
+            nativeOut = argv[++i];
+        }
+        else if (arg == "--alloc-stats")
+            allocStats = true;
+        else if (arg == "--profile")
+            profile = true;
+        else if (arg == "--profile-json" && i + 1 < argc)
+            profileJson = argv[++i];
+        else if (arg == "--input" && i + 1 < argc)
+            inputName = argv[++i];
+        else if (arg[0] == '-')
+        {
+            cout << "UNRECOGNIZED FLAG " << arg << endl;
+            return 1;
+        }
+        else if (fileName != nullptr)
+        {
+            cout << "ONLY ONE FILE NAME IS ALLOWED." << endl;
+            return 1;
+        }
+        else
+            fileName = argv[i];
+    }
+
+    if (fileName == nullptr)
+    {
+        Usage(argv[0]);
+        return 1;
+    }
+
+    bool prebuilt = EndsWith(fileName, ".so");
+    LexBuffer file;
+    if (!prebuilt && !file.Map(fileName))
+    {
+        cout << "CANNOT OPEN THE FILE " << fileName << endl;
+        return 1;
+    }
+
+    // --stream and --batch open the input themselves: the stream reads it a block at a time, so it must not be mapped
+    // whole here first
+    bool perRecord = (stream || batch) && !prebuilt;
+    if (inputName != nullptr && !perRecord && !StdIn.Open(inputName))
+    {
+        cout << "CANNOT OPEN THE FILE " << inputName << endl;
+        return 1;
+    }
+
+    Profiler profiler;
+    if (profile || profileJson != nullptr)
+    {
+        useTree = true;
+        Ctx->Prof = &profiler;
+    }
+
+    int line = 1;
+    ProgNode* prog = nullptr;
+    // A prebuilt procedure was complete when it was built; a source one is when nothing follows its END
+    LexItem after(DONE, "", 0);
+    bool status = prebuilt || ParseProg(file, line, prog, &after);
+    if (prebuilt)
+    {
+        NativeProgram native;
+        string error;
+        if (!native.Load(fileName, error))
+        {
+            cout << "CANNOT LOAD THE FILE " << fileName << ": " << error << endl;
+            return 1;
+        }
+        status = native.Run();
+    }
+    else if (status)
+    {
+        if (emitCpp)
+        {
+            EmitNative(prog, cout);
+            delete prog;
+            return 0;
+        }
+
+        if (batch)
+        {
+            CompiledProgram compiled;
+            compiled.ok = status = CompileProg(prog, compiled.chunk);
+            // The whole input is split up front, so map the file rather than reading it
+            unique_ptr<LexBuffer> records = inputName != nullptr ? make_unique<LexBuffer>() : make_unique<LexBuffer>(cin);
+            if (inputName != nullptr && !records->Map(inputName))
+            {
+                cout << "CANNOT OPEN THE FILE " << inputName << endl;
+                status = false;
+            }
+            ColumnarProgram columns;
+            string reason;
+            if (status && columnar && !BuildColumnar(prog, columns, reason))
+            {
+                cerr << "columnar: " << reason << "; running the records one at a time" << endl;
+                columnar = false;
+            }
+            if (status)
+            {
+                StreamStats stats = columnar ? RunColumnar(columns, compiled, records->Text(), StdOut)
+                                             : RunParallel(compiled, records->Text(), StdOut, workers);
+                Ctx->error_count += stats.errors;
+                status = stats.failed == 0;
+            }
+        }
+        else if (stream)
+        {
+            CompiledProgram compiled;
+            compiled.ok = status = CompileProg(prog, compiled.chunk);
+            int fd = inputName != nullptr ? open(inputName, O_RDONLY) : 0;
+            if (fd < 0)
+            {
+                cout << "CANNOT OPEN THE FILE " << inputName << endl;
+                status = false;
+            }
+            if (status)
+            {
+                // The records run in a context of their own; count their errors with the parse's
+                StreamStats stats = RunStream(compiled, fd, StdOut);
+                Ctx->error_count += stats.errors;
+                status = stats.failed == 0;
+            }
+            if (fd > 0)
+                close(fd);
+        }
+        else if (useTree)
+        {
+            status = RunProg(prog);
+            StdOut.Flush();
+            if (profileJson != nullptr)
+            {
+                ofstream json(profileJson);
+                profiler.WriteJson(json);
+            }
+            else if (profile)
+                profiler.Report(cerr);
+        }
+        else if (useNative)
+        {
+            NativeProgram native;
+            if (!LoadNative(prog, nativeOut, native))
+            {
+                delete prog;
+                return 1;
+            }
+            status = native.Run();
+        }
+        else
+        {
+            Chunk chunk;
+            status = CompileProg(prog, chunk);
+            if (status && emitBytecode)
+            {
+                DumpChunk(chunk, cout);
+                delete prog;
+                return 0;
+            }
+            if (status)
+            {
+                // A single run never gets hot, so --jit compiles before the first
+                JitCode jit;
+                status = RunChunk(chunk, useJit && JitCompile(chunk, jit) ? &jit : nullptr);
+            }
+        }
+        delete prog;
+    }
+    if (allocStats)
+        PrintAllocStats();
+
+    if (!status)
+    {
+        StdOut << "\nUnsuccessful Interpretation \n" << "Number of Errors " << ErrCount() << '\n';
+        StdOut.Flush();
+        return 1;
+    }
+
+    if (after == DONE)
+        StdOut << "\n(DONE)\n";
+    StdOut.Flush();
+    return 0;
+}
@@ -0,0 +1,142 @@
+/* Constant folding: replace operators whose operands are all constants by the constant they produce */
+#include "fold.h"
+#include "treeInterp.h"
+
+// Compute a unary operator on a constant the way EvalUnary would. False if that would be a run-time error
+static bool FoldUnary(Token op, const Value& val, Value& retVal)
+{
+    if (op == MINUS)
+    {
+        if (!val.IsInt() && !val.IsReal())
+            return false;
+        retVal = val.IsInt() ? Value(IntNeg(val.GetInt())) : Value(-val.GetReal());
+        return true;
+    }
+
+    retVal = !val;
+    return !retVal.IsErr();
+}
+
+// Compute a binary operator on constants the way EvalBinary would. False if the operator raises an error
+// or yields an error value (division by zero, mismatched types), so it stays for the run to report
+static bool FoldBinary(Token op, const Value& val1, const Value& val2, Value& retVal)
+{
+    retVal = ApplyBinary(op, val1, val2);
+    return !retVal.IsErr();
+}
+
+static void FoldList(ProgNode* prog, vector<StmtNode*>& stmts);
+
+static const Value* ConstOf(ExprNode* expr)
+{
+    return expr->kind == CONST_NODE ? &static_cast<ConstNode*>(expr)->val : nullptr;
+}
+
+// Fold the subexpressions of expr bottom-up and return the node that replaces it
+ExprNode* FoldExpr(ProgNode* prog, ExprNode* expr)
+{
+    if (expr == nullptr)
+        return nullptr;
+
+    Value result;
+    switch (expr->kind)
+    {
+        case NAME_NODE:
+        {
+            // The string is always a variable; only literal index and slice bounds fold
+            NameNode* name = static_cast<NameNode*>(expr);
+            name->index1 = FoldExpr(prog, name->index1);
+            name->index2 = FoldExpr(prog, name->index2);
+            return expr;
+        }
+        case UNARY_NODE:
+        {
+            UnaryNode* unary = static_cast<UnaryNode*>(expr);
+            unary->operand = FoldExpr(prog, unary->operand);
+            const Value* val = ConstOf(unary->operand);
+            if (val == nullptr || !FoldUnary(unary->op, *val, result))
+                return expr;
+            break;
+        }
+        case BINARY_NODE:
+        {
+            BinaryNode* binary = static_cast<BinaryNode*>(expr);
+            binary->left = FoldExpr(prog, binary->left);
+            binary->right = FoldExpr(prog, binary->right);
+            const Value* val1 = ConstOf(binary->left);
+            const Value* val2 = ConstOf(binary->right);
+            if (val1 == nullptr || val2 == nullptr || !FoldBinary(binary->op, *val1, *val2, result))
+                return expr;
+            break;
+        }
+        default:
+            return expr;
+    }
+    return prog->New<ConstNode>(std::move(result), expr->line);
+}
+
+static void FoldStmt(ProgNode* prog, StmtNode* stmt)
+{
+    switch (stmt->kind)
+    {
+        case DECL_NODE:
+        {
+            DeclNode* decl = static_cast<DeclNode*>(stmt);
+            decl->init = FoldExpr(prog, decl->init);
+            break;
+        }
+        case ASSIGN_NODE:
+        {
+            AssignNode* assign = static_cast<AssignNode*>(stmt);
+            assign->expr = FoldExpr(prog, assign->expr);
+            break;
+        }
+        case PRINT_NODE:
+        {
+            PrintNode* print = static_cast<PrintNode*>(stmt);
+            print->expr = FoldExpr(prog, print->expr);
+            break;
+        }
+        case IF_NODE:
+        {
+            IfNode* ifNode = static_cast<IfNode*>(stmt);
+            for (IfArm& arm : ifNode->arms)
+            {
+                arm.cond = FoldExpr(prog, arm.cond);
+                FoldList(prog, arm.body);
+            }
+            FoldList(prog, ifNode->elseBody);
+            break;
+        }
+        case WHILE_NODE:
+        {
+            WhileNode* loop = static_cast<WhileNode*>(stmt);
+            loop->cond = FoldExpr(prog, loop->cond);
+            FoldList(prog, loop->body);
+            break;
+        }
+        case FOR_NODE:
+        {
+            ForNode* loop = static_cast<ForNode*>(stmt);
+            loop->low = FoldExpr(prog, loop->low);
+            loop->high = FoldExpr(prog, loop->high);
+            FoldList(prog, loop->body);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+static void FoldList(ProgNode* prog, vector<StmtNode*>& stmts)
+{
+    for (StmtNode* stmt : stmts)
+        FoldStmt(prog, stmt);
+}
+
+// Fold every expression of a parsed procedure. Nodes that are replaced stay owned by prog
+void FoldProg(ProgNode* prog)
+{
+    FoldList(prog, prog->decls);
+    FoldList(prog, prog->body);
+}
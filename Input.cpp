@@ -0,0 +1,138 @@
+/* Input sources for GET statements */
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "input.h"
+
+InputSource StdIn(0);
+
+InputSource::InputSource(int fd, size_t capacity) : buf(capacity), fd(fd), eof(false)
+{
+    cur = end = buf.data();
+}
+
+InputSource::InputSource(istream& in, size_t capacity) : buf(capacity), stream(&in), eof(false)
+{
+    cur = end = buf.data();
+}
+
+void InputSource::Close()
+{
+    if (mapped)
+        munmap(mapped, mappedSize);
+    if (ownsFd)
+        close(fd);
+    mapped = nullptr;
+    ownsFd = false;
+    fd = -1;
+    stream = nullptr;
+}
+
+bool InputSource::Open(const string& path)
+{
+    Close();
+    int file = open(path.c_str(), O_RDONLY);
+    if (file < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(file, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0)
+    {
+        void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+        if (addr != MAP_FAILED)
+        {
+            close(file);
+            madvise(addr, st.st_size, MADV_SEQUENTIAL);
+            mapped = addr;
+            mappedSize = st.st_size;
+            cur = static_cast<const char*>(addr);
+            end = cur + st.st_size;
+            eof = true;
+            return true;
+        }
+    }
+
+    fd = file;
+    ownsFd = true;
+    eof = false;
+    if (buf.empty())
+        buf.resize(1 << 16);
+    cur = end = buf.data();
+    return true;
+}
+
+// Read more input after the unread text from start on, which moves to the front of the buffer.
+// The buffer grows when start is already at the front and it is full. False once nothing more arrives
+bool InputSource::Refill(const char*& start)
+{
+    if (eof)
+        return false;
+
+    size_t kept = end - start;
+    memmove(buf.data(), start, kept);
+    if (kept == buf.size())
+        buf.resize(buf.size() * 2);
+    start = buf.data();
+
+    ssize_t n;
+    if (stream != nullptr)
+        n = stream->rdbuf()->sgetn(buf.data() + kept, buf.size() - kept);
+    else
+    {
+        do
+            n = read(fd, buf.data() + kept, buf.size() - kept);
+        while (n < 0 && errno == EINTR);
+    }
+
+    cur = start;
+    end = buf.data() + kept + max<ssize_t>(n, 0);
+    if (n <= 0)
+        eof = true;
+    return n > 0;
+}
+
+static inline bool IsSpace(char c)
+{
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\f' || c == '\v';
+}
+
+bool InputSource::Next(string_view& word)
+{
+    const char* p = cur;
+    for (;;)
+    {
+        while (p < end && IsSpace(*p))
+            p++;
+        if (p < end)
+            break;
+        cur = p;
+        if (!Refill(p))
+        {
+            word = string_view();
+            return false;
+        }
+    }
+
+    const char* start = p;
+    for (;;)
+    {
+        while (p < end && !IsSpace(*p))
+            p++;
+        if (p < end)
+            break;
+        // Refill moves the word's start even when no more input arrives, so p must follow it either way
+        size_t len = p - start;
+        bool more = Refill(start);
+        p = start + len;
+        if (!more)
+            break;
+    }
+
+    word = string_view(start, p - start);
+    cur = p;
+    return true;
+}
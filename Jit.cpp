@@ -0,0 +1,462 @@
+/* JIT tier: typed bytecode compiled to x86-64 machine code, with the VM executing whatever it leaves out */
+#include <cstring>
+#include <initializer_list>
+#include <sys/mman.h>
+#include "jit.h"
+
+atomic<uint64_t> JitThreshold{100};
+
+JitCode::~JitCode()
+{
+    if (memory != nullptr)
+        munmap(memory, size);
+}
+
+const JitCode* JitTier::Enter(const Chunk& chunk)
+{
+    uint64_t threshold = JitThreshold.load(memory_order_relaxed);
+    uint64_t run = runs.fetch_add(1, memory_order_relaxed) + 1;
+
+    // Exactly one run compiles; runs on other threads meanwhile carry on in the VM
+    if (threshold != 0 && run >= threshold && !tried.exchange(true))
+    {
+        JitCode* compiled = new JitCode;
+        if (JitCompile(chunk, *compiled))
+            code.store(compiled, memory_order_release);
+        else
+            delete compiled;
+    }
+    return code.load(memory_order_acquire);
+}
+
+#if defined(__x86_64__)
+
+// Value layout the generated code relies on: the type tag in the first byte, the payload at offset 8
+static const int TagOffset = 0;
+static const int PayloadOffset = 8;
+
+// Check the layout on a sample value rather than trusting it
+static bool LayoutMatches()
+{
+    Value sample(0x12345678);
+    unsigned char bytes[sizeof(Value)];
+    memcpy(bytes, static_cast<const void*>(&sample), sizeof bytes);
+    int payload;
+    memcpy(&payload, bytes + PayloadOffset, sizeof payload);
+    return bytes[TagOffset] == VINT && payload == 0x12345678;
+}
+
+// x86-64 condition codes
+enum Cond : uint8_t
+{
+    CC_B = 0x2, CC_AE = 0x3, CC_E = 0x4, CC_NE = 0x5, CC_BE = 0x6, CC_A = 0x7,
+    CC_P = 0xA, CC_NP = 0xB, CC_L = 0xC, CC_GE = 0xD, CC_LE = 0xE, CC_G = 0xF
+};
+
+enum Reg { EAX = 0, ECX = 1, EDX = 2 };
+
+// Emits the machine code of one chunk. The register file's address stays in rdi, the first argument, and only
+// rax, rcx, rdx and xmm0 are used, so any instruction's code can be entered directly as a function
+class Assembler
+{
+    const Chunk& chunk;
+    vector<uint8_t> out;
+    vector<bool> compiled;
+    vector<size_t> labels;
+    vector<pair<size_t, uint32_t>> fixups;      // rel32 to patch, pc it jumps to
+
+    static int Tag(uint32_t reg) { return (int)reg * (int)sizeof(Value) + TagOffset; }
+    static int Payload(uint32_t reg) { return (int)reg * (int)sizeof(Value) + PayloadOffset; }
+
+    void Bytes(initializer_list<uint8_t> bytes) { out.insert(out.end(), bytes); }
+
+    void Imm32(uint32_t v)
+    {
+        for (int i = 0; i < 4; i++)
+            out.push_back((uint8_t)(v >> (8 * i)));
+    }
+
+    // An instruction with operand [rdi + disp32]: the opcode bytes, then ModRM with reg in the reg field
+    void Mem(initializer_list<uint8_t> opcode, int reg, int disp)
+    {
+        Bytes(opcode);
+        out.push_back((uint8_t)(0x80 | (reg << 3) | 7));
+        Imm32((uint32_t)disp);
+    }
+
+    // Return pc to the VM
+    void Exit(uint32_t pc)
+    {
+        out.push_back(0xB8);
+        Imm32(pc);
+        out.push_back(0xC3);
+    }
+
+    // Return pc to the VM when condition cc holds, skipping the 6-byte exit otherwise
+    void ExitIf(Cond cc, uint32_t pc)
+    {
+        Bytes({ (uint8_t)(0x70 | (cc ^ 1)), 6 });
+        Exit(pc);
+    }
+
+    // Continue at instruction pc: in machine code when it is compiled, otherwise in the VM
+    void JumpIf(Cond cc, uint32_t pc)
+    {
+        if (!compiled[pc])
+        {
+            ExitIf(cc, pc);
+            return;
+        }
+        Bytes({ 0x0F, (uint8_t)(0x80 | cc) });
+        fixups.push_back({ out.size(), pc });
+        Imm32(0);
+    }
+
+    void Jump(uint32_t pc)
+    {
+        if (!compiled[pc])
+        {
+            Exit(pc);
+            return;
+        }
+        out.push_back(0xE9);
+        fixups.push_back({ out.size(), pc });
+        Imm32(0);
+    }
+
+    void CmpTag(uint32_t reg, ValType type)
+    {
+        Mem({ 0x80 }, 7, Tag(reg));
+        out.push_back(type);
+    }
+
+    // A typed result may not overwrite a string, which must be released: leave that to the VM
+    void GuardDest(uint32_t reg, uint32_t pc)
+    {
+        CmpTag(reg, VSTRING);
+        ExitIf(CC_E, pc);
+    }
+
+    // Set the tag and clear the length word, as the Store methods of Value do
+    void SetTag(uint32_t reg, ValType type)
+    {
+        Mem({ 0x48, 0xC7 }, 0, Tag(reg));
+        Imm32(type);
+    }
+
+    void StoreInt(uint32_t reg, Reg src)
+    {
+        SetTag(reg, VINT);
+        Mem({ 0x89 }, src, Payload(reg));
+    }
+
+    void StoreReal(uint32_t reg)
+    {
+        SetTag(reg, VREAL);
+        Mem({ 0xF2, 0x0F, 0x11 }, 0, Payload(reg));
+    }
+
+    void StoreBool(uint32_t reg)
+    {
+        SetTag(reg, VBOOL);
+        Mem({ 0x88 }, EAX, Payload(reg));
+    }
+
+    void SetCC(Cond cc, Reg reg) { Bytes({ 0x0F, (uint8_t)(0x90 | cc), (uint8_t)(0xC0 | reg) }); }
+
+    void IntArith(const Instr& I, initializer_list<uint8_t> opcode)
+    {
+        Mem({ 0x8B }, EAX, Payload(I.b));
+        Mem(opcode, EAX, Payload(I.c));
+        StoreInt(I.a, EAX);
+    }
+
+    void IntCompare(const Instr& I, Cond cc)
+    {
+        Mem({ 0x8B }, EAX, Payload(I.b));
+        Mem({ 0x3B }, EAX, Payload(I.c));
+        SetCC(cc, EAX);
+        StoreBool(I.a);
+    }
+
+    void RealArith(const Instr& I, uint8_t opcode)
+    {
+        Mem({ 0xF2, 0x0F, 0x10 }, 0, Payload(I.b));
+        Mem({ 0xF2, 0x0F, opcode }, 0, Payload(I.c));
+        StoreReal(I.a);
+    }
+
+    // Compare the right operand with the left, so an unordered pair (a NaN) answers false to both
+    // "above" tests, as the Value comparisons on reals do
+    void RealCompare(const Instr& I, Cond cc)
+    {
+        Mem({ 0xF2, 0x0F, 0x10 }, 0, Payload(I.c));
+        Mem({ 0x66, 0x0F, 0x2E }, 0, Payload(I.b));
+        SetCC(cc, EAX);
+        StoreBool(I.a);
+    }
+
+    // Equality must also be ordered: ZF alone is set for NaNs too
+    void RealEqual(const Instr& I, bool equal)
+    {
+        Mem({ 0xF2, 0x0F, 0x10 }, 0, Payload(I.b));
+        Mem({ 0x66, 0x0F, 0x2E }, 0, Payload(I.c));
+        SetCC(equal ? CC_E : CC_NE, EAX);
+        SetCC(equal ? CC_NP : CC_P, ECX);
+        Bytes({ (uint8_t)(equal ? 0x20 : 0x08), 0xC8 });
+        StoreBool(I.a);
+    }
+
+    bool Instruction(uint32_t pc, const Instr& I);
+
+public:
+    explicit Assembler(const Chunk& chunk) : chunk(chunk), compiled(chunk.code.size() + 1), labels(chunk.code.size()) {}
+
+    bool Assemble(JitCode::Entry* entries, void*& memory, size_t& size);
+};
+
+// Instructions with machine code: the typed forms, whose operands are known to hold their types, and the
+// moves, checks and jumps around them
+static bool Compilable(Opcode op)
+{
+    switch (op)
+    {
+        case OP_MOVE: case OP_CHKINIT: case OP_CHKSTR: case OP_CHKTYPE:
+        case OP_IADD: case OP_ISUB: case OP_IMUL: case OP_IDIV: case OP_IMOD:
+        case OP_IEQ: case OP_INEQ: case OP_ILT: case OP_ILTE: case OP_IGT: case OP_IGTE: case OP_INEG:
+        case OP_RADD: case OP_RSUB: case OP_RMUL: case OP_RDIV:
+        case OP_REQ: case OP_RNEQ: case OP_RLT: case OP_RLTE: case OP_RGT: case OP_RGTE: case OP_RNEG:
+        case OP_BAND: case OP_BOR: case OP_BNOT: case OP_ITOR:
+        case OP_JMP: case OP_JMPF: case OP_FORPREP: case OP_FORLOOP:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static bool TagOf(Token type, ValType& tag)
+{
+    switch (type)
+    {
+        case INT: tag = VINT; return true;
+        case FLOAT: tag = VREAL; return true;
+        case BOOL: tag = VBOOL; return true;
+        case STRING: tag = VSTRING; return true;
+        case CHAR: tag = VCHAR; return true;
+        default: return false;
+    }
+}
+
+// Emit one instruction. A failing check exits at the instruction itself, so the VM reports the error
+bool Assembler::Instruction(uint32_t pc, const Instr& I)
+{
+    switch (I.op)
+    {
+        case OP_MOVE:
+            // A string needs its reference count adjusted; everything else is copied as 16 bytes
+            if (I.a == I.b)
+                break;
+            CmpTag(I.b, VSTRING);
+            ExitIf(CC_E, pc);
+            GuardDest(I.a, pc);
+            Mem({ 0x0F, 0x10 }, 0, Tag(I.b));
+            Mem({ 0x0F, 0x11 }, 0, Tag(I.a));
+            break;
+        case OP_CHKINIT:
+            CmpTag(I.a, VERR);
+            ExitIf(CC_E, pc);
+            break;
+        case OP_CHKSTR:
+            CmpTag(I.a, VSTRING);
+            ExitIf(CC_NE, pc);
+            break;
+        case OP_CHKTYPE:
+        {
+            ValType tag;
+            if (!TagOf((Token)I.b, tag))
+            {
+                Exit(pc);
+                break;
+            }
+            CmpTag(I.a, tag);
+            ExitIf(CC_NE, pc);
+            break;
+        }
+
+        case OP_IADD: GuardDest(I.a, pc); IntArith(I, { 0x03 }); break;
+        case OP_ISUB: GuardDest(I.a, pc); IntArith(I, { 0x2B }); break;
+        case OP_IMUL: GuardDest(I.a, pc); IntArith(I, { 0x0F, 0xAF }); break;
+        case OP_IDIV: case OP_IMOD:
+            // cdq; idiv leaves the quotient in eax and the remainder in edx. idiv faults on INT_MIN / -1, so a
+            // divisor of -1 (cmp dword [c], -1) exits to the VM, which wraps as val.h defines
+            GuardDest(I.a, pc);
+            Mem({ 0x83 }, 7, Payload(I.c));
+            out.push_back(0xFF);
+            ExitIf(CC_E, pc);
+            Mem({ 0x8B }, EAX, Payload(I.b));
+            out.push_back(0x99);
+            Mem({ 0xF7 }, 7, Payload(I.c));
+            StoreInt(I.a, I.op == OP_IDIV ? EAX : EDX);
+            break;
+        case OP_INEG:
+            GuardDest(I.a, pc);
+            Mem({ 0x8B }, EAX, Payload(I.b));
+            Bytes({ 0xF7, 0xD8 });
+            StoreInt(I.a, EAX);
+            break;
+        case OP_IEQ: GuardDest(I.a, pc); IntCompare(I, CC_E); break;
+        case OP_INEQ: GuardDest(I.a, pc); IntCompare(I, CC_NE); break;
+        case OP_ILT: GuardDest(I.a, pc); IntCompare(I, CC_L); break;
+        case OP_ILTE: GuardDest(I.a, pc); IntCompare(I, CC_LE); break;
+        case OP_IGT: GuardDest(I.a, pc); IntCompare(I, CC_G); break;
+        case OP_IGTE: GuardDest(I.a, pc); IntCompare(I, CC_GE); break;
+
+        case OP_RADD: GuardDest(I.a, pc); RealArith(I, 0x58); break;
+        case OP_RSUB: GuardDest(I.a, pc); RealArith(I, 0x5C); break;
+        case OP_RMUL: GuardDest(I.a, pc); RealArith(I, 0x59); break;
+        case OP_RDIV: GuardDest(I.a, pc); RealArith(I, 0x5E); break;
+        case OP_RNEG:
+            // Flip the sign bit: mov rax, [b]; btc rax, 63
+            GuardDest(I.a, pc);
+            Mem({ 0x48, 0x8B }, EAX, Payload(I.b));
+            Bytes({ 0x48, 0x0F, 0xBA, 0xF8, 0x3F });
+            SetTag(I.a, VREAL);
+            Mem({ 0x48, 0x89 }, EAX, Payload(I.a));
+            break;
+        case OP_REQ: GuardDest(I.a, pc); RealEqual(I, true); break;
+        case OP_RNEQ: GuardDest(I.a, pc); RealEqual(I, false); break;
+        case OP_RLT: GuardDest(I.a, pc); RealCompare(I, CC_A); break;
+        case OP_RLTE: GuardDest(I.a, pc); RealCompare(I, CC_AE); break;
+        case OP_RGT: GuardDest(I.a, pc); RealCompare(I, CC_B); break;
+        case OP_RGTE: GuardDest(I.a, pc); RealCompare(I, CC_BE); break;
+        case OP_ITOR:
+            GuardDest(I.a, pc);
+            Mem({ 0xF2, 0x0F, 0x2A }, 0, Payload(I.b));
+            StoreReal(I.a);
+            break;
+
+        case OP_BAND: case OP_BOR:
+            GuardDest(I.a, pc);
+            Mem({ 0x8A }, EAX, Payload(I.b));
+            Mem({ (uint8_t)(I.op == OP_BAND ? 0x22 : 0x0A) }, EAX, Payload(I.c));
+            StoreBool(I.a);
+            break;
+        case OP_BNOT:
+            GuardDest(I.a, pc);
+            Mem({ 0x8A }, EAX, Payload(I.b));
+            Bytes({ 0x34, 0x01 });
+            StoreBool(I.a);
+            break;
+
+        case OP_JMP:
+            Jump(I.a);
+            return false;
+        case OP_JMPF:
+            CmpTag(I.a, VBOOL);
+            ExitIf(CC_NE, pc);
+            Mem({ 0x80 }, 7, Payload(I.a));
+            out.push_back(0);
+            JumpIf(CC_E, I.b);
+            break;
+        case OP_FORPREP:
+            CmpTag(I.a, VINT);
+            ExitIf(CC_NE, pc);
+            CmpTag(I.b, VINT);
+            ExitIf(CC_NE, pc);
+            Mem({ 0x8B }, EAX, Payload(I.a));
+            Mem({ 0x3B }, EAX, Payload(I.b));
+            JumpIf(CC_G, I.c);
+            break;
+        case OP_FORLOOP:
+        {
+            // if (var < limit) { var += 1; goto body; }
+            Mem({ 0x8B }, EAX, Payload(I.a));
+            Mem({ 0x3B }, EAX, Payload(I.b));
+            Bytes({ 0x70 | CC_GE, 0 });
+            size_t skip = out.size();
+            Bytes({ 0xFF, 0xC0 });
+            Mem({ 0x89 }, EAX, Payload(I.a));
+            Jump(I.c);
+            out[skip - 1] = (uint8_t)(out.size() - skip);
+            break;
+        }
+        default:
+            break;
+    }
+    return true;
+}
+
+// Lay out the compiled instructions in program order, each falling through to the next or returning to the VM
+bool Assembler::Assemble(JitCode::Entry* entries, void*& memory, size_t& size)
+{
+    size_t count = 0;
+    for (size_t pc = 0; pc < chunk.code.size(); pc++)
+    {
+        compiled[pc] = Compilable(chunk.code[pc].op);
+        count += compiled[pc];
+    }
+    if (count == 0)
+        return false;
+
+    for (size_t pc = 0; pc < chunk.code.size(); pc++)
+    {
+        if (!compiled[pc])
+            continue;
+        labels[pc] = out.size();
+        if (Instruction((uint32_t)pc, chunk.code[pc]) && !compiled[pc + 1])
+            Exit((uint32_t)pc + 1);
+    }
+
+    for (auto& [at, pc] : fixups)
+    {
+        uint32_t rel = (uint32_t)(labels[pc] - (at + 4));
+        memcpy(&out[at], &rel, sizeof rel);
+    }
+
+    // Written while writable, then made executable and read-only
+    size = out.size();
+    memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED)
+    {
+        memory = nullptr;
+        return false;
+    }
+    memcpy(memory, out.data(), size);
+    if (mprotect(memory, size, PROT_READ | PROT_EXEC) != 0)
+    {
+        munmap(memory, size);
+        memory = nullptr;
+        return false;
+    }
+
+    for (size_t pc = 0; pc < chunk.code.size(); pc++)
+    {
+        if (compiled[pc])
+            entries[pc] = reinterpret_cast<JitCode::Entry>(static_cast<uint8_t*>(memory) + labels[pc]);
+    }
+    return true;
+}
+
+bool JitCompile(const Chunk& chunk, JitCode& code)
+{
+    if (!LayoutMatches())
+        return false;
+
+    code.entries.assign(chunk.code.size(), nullptr);
+    Assembler assembler(chunk);
+    if (!assembler.Assemble(code.entries.data(), code.memory, code.size))
+    {
+        code.entries.clear();
+        return false;
+    }
+    return true;
+}
+
+#else
+
+bool JitCompile(const Chunk&, JitCode&)
+{
+    return false;
+}
+
+#endif
@@ -0,0 +1,350 @@
+/* Lexical analyzer for the SADAL Language */
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "lex.h"
+
+// Reserved words, matched case-insensitively; true and false become boolean constants.
+// id_or_kw recognizes them with a switch instead of searching this table
+const map<string, Token, less<>> keywords =
+{
+    {"if", IF}, {"else", ELSE}, {"elsif", ELSIF}, {"put", PUT}, {"putline", PUTLN},
+    {"get", GET}, {"integer", INT}, {"float", FLOAT}, {"character", CHAR},
+    {"string", STRING}, {"boolean", BOOL}, {"procedure", PROCEDURE}, {"true", TRUE},
+    {"false", FALSE}, {"end", END}, {"is", IS}, {"begin", BEGIN}, {"then", THEN},
+    {"constant", CONST}, {"and", AND}, {"or", OR}, {"not", NOT}, {"mod", MOD},
+    {"loop", LOOP}, {"while", WHILE}, {"for", FOR}, {"in", IN}
+};
+
+static const char* TokenNames[] =
+{
+    "IF", "ELSE", "ELSIF", "PUT", "PUTLN", "GET", "INT", "FLOAT",
+    "CHAR", "STRING", "BOOL", "PROCEDURE", "TRUE", "FALSE", "END",
+    "IS", "BEGIN", "THEN", "CONST", "LOOP", "WHILE", "FOR", "IN",
+    "IDENT",
+    "ICONST", "FCONST", "SCONST", "BCONST", "CCONST",
+    "PLUS", "MINUS", "MULT", "DIV", "ASSOP", "EQ", "NEQ", "EXP", "CONCAT",
+    "GTHAN", "LTHAN", "LTE", "GTE", "AND", "OR", "NOT", "MOD",
+    "COMMA", "SEMICOL", "LPAREN", "RPAREN", "DOT", "COLON",
+    "ERR",
+    "DONE"
+};
+
+ostream& operator<<(ostream& out, const LexItem& tok)
+{
+    Token token = tok.GetToken();
+    out << TokenNames[token];
+    if (token == IDENT || token == ICONST || token == FCONST || token == SCONST ||
+        token == BCONST || token == CCONST || token == ERR)
+        out << ": (" << tok.GetLexeme() << ")";
+    return out;
+}
+
+LexBuffer::LexBuffer(istream& in) : LexBuffer()
+{
+    ostringstream text;
+    text << in.rdbuf();
+    owned = text.str();
+    base = owned.data();
+    size = owned.size();
+}
+
+LexBuffer::LexBuffer(string src) : LexBuffer()
+{
+    owned = std::move(src);
+    base = owned.data();
+    size = owned.size();
+}
+
+LexBuffer::~LexBuffer()
+{
+    if (mapped)
+        munmap(const_cast<char*>(base), size);
+}
+
+// Map a source file read-only. Files that cannot be mapped (pipes, empty files) are read into memory instead
+bool LexBuffer::Map(const string& path)
+{
+    if (mapped)
+        munmap(const_cast<char*>(base), size);
+    mapped = false;
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0)
+    {
+        void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr != MAP_FAILED)
+        {
+            close(fd);
+            madvise(addr, st.st_size, MADV_SEQUENTIAL);
+            base = static_cast<const char*>(addr);
+            size = st.st_size;
+            pos = 0;
+            mapped = true;
+            return true;
+        }
+    }
+
+    string text;
+    char chunk[65536];
+    ssize_t n;
+    while ((n = read(fd, chunk, sizeof(chunk))) > 0)
+        text.append(chunk, n);
+    close(fd);
+    if (n < 0)
+        return false;
+
+    owned = std::move(text);
+    base = owned.data();
+    size = owned.size();
+    pos = 0;
+    return true;
+}
+
+int NameTable::Intern(string_view name)
+{
+    auto it = ids.find(name);
+    if (it != ids.end())
+        return it->second;
+
+    string_view copy = text.Copy(name);
+    int id = (int)names.size();
+    names.push_back(copy);
+    ids.emplace(copy, id);
+    return id;
+}
+
+void NameTable::Clear()
+{
+    ids.clear();
+    names.clear();
+    text.Reset();
+}
+
+static inline bool IsLetter(char c)
+{
+    return (unsigned)((c | 0x20) - 'a') < 26;
+}
+
+static inline bool IsDigit(char c)
+{
+    return (unsigned)(c - '0') < 10;
+}
+
+// Case-insensitive match of a lexeme against a lowercase reserved word of the same length
+static inline bool KeywordIs(string_view lexeme, const char* word)
+{
+    for (size_t i = 1; i < lexeme.size(); i++)
+    {
+        if ((lexeme[i] | 0x20) != word[i])
+            return false;
+    }
+    return true;
+}
+
+// Reserved word lookup without a table: dispatch on length, then on the first letter, then compare the rest.
+// Every lexeme reaching here starts with a letter, so OR-ing 0x20 lowercases it. Must agree with keywords
+static Token FindKeyword(string_view w)
+{
+    if (w.empty())
+        return IDENT;
+
+    char first = w[0] | 0x20;
+    switch (w.size())
+    {
+        case 2:
+            if (first == 'i') return KeywordIs(w, "if") ? IF : KeywordIs(w, "is") ? IS : KeywordIs(w, "in") ? IN : IDENT;
+            if (first == 'o') return KeywordIs(w, "or") ? OR : IDENT;
+            break;
+        case 3:
+            switch (first)
+            {
+                case 'a': return KeywordIs(w, "and") ? AND : IDENT;
+                case 'e': return KeywordIs(w, "end") ? END : IDENT;
+                case 'f': return KeywordIs(w, "for") ? FOR : IDENT;
+                case 'g': return KeywordIs(w, "get") ? GET : IDENT;
+                case 'm': return KeywordIs(w, "mod") ? MOD : IDENT;
+                case 'n': return KeywordIs(w, "not") ? NOT : IDENT;
+                case 'p': return KeywordIs(w, "put") ? PUT : IDENT;
+            }
+            break;
+        case 4:
+            if (first == 'e') return KeywordIs(w, "else") ? ELSE : IDENT;
+            if (first == 'l') return KeywordIs(w, "loop") ? LOOP : IDENT;
+            if (first == 't') return KeywordIs(w, "then") ? THEN : KeywordIs(w, "true") ? TRUE : IDENT;
+            break;
+        case 5:
+            switch (first)
+            {
+                case 'b': return KeywordIs(w, "begin") ? BEGIN : IDENT;
+                case 'e': return KeywordIs(w, "elsif") ? ELSIF : IDENT;
+                case 'f': return KeywordIs(w, "float") ? FLOAT : KeywordIs(w, "false") ? FALSE : IDENT;
+                case 'w': return KeywordIs(w, "while") ? WHILE : IDENT;
+            }
+            break;
+        case 6:
+            if (first == 's') return KeywordIs(w, "string") ? STRING : IDENT;
+            break;
+        case 7:
+            switch (first)
+            {
+                case 'b': return KeywordIs(w, "boolean") ? BOOL : IDENT;
+                case 'i': return KeywordIs(w, "integer") ? INT : IDENT;
+                case 'p': return KeywordIs(w, "putline") ? PUTLN : IDENT;
+            }
+            break;
+        case 8:
+            if (first == 'c') return KeywordIs(w, "constant") ? CONST : IDENT;
+            break;
+        case 9:
+            if (first == 'c') return KeywordIs(w, "character") ? CHAR : IDENT;
+            if (first == 'p') return KeywordIs(w, "procedure") ? PROCEDURE : IDENT;
+            break;
+    }
+    return IDENT;
+}
+
+// Classify an identifier-shaped lexeme as a reserved word, boolean constant or identifier
+LexItem id_or_kw(string_view lexeme, int linenum)
+{
+    Token token = FindKeyword(lexeme);
+    if (token == TRUE)
+        return LexItem(BCONST, "true", linenum);
+    if (token == FALSE)
+        return LexItem(BCONST, "false", linenum);
+    return LexItem(token, lexeme, linenum);
+}
+
+// Scan the next token directly from the buffer. Whitespace and -- comments are skipped, newlines counted
+LexItem getNextToken(LexBuffer& in, int& linenum)
+{
+    const char* p = in.base + in.pos;
+    const char* end = in.base + in.size;
+
+    while (p < end)
+    {
+        char c = *p;
+        if (c == '\n')
+        {
+            linenum++;
+            p++;
+        }
+        else if (c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v')
+            p++;
+        else if (c == '-' && p + 1 < end && p[1] == '-')
+        {
+            while (p < end && *p != '\n')
+                p++;
+        }
+        else
+            break;
+    }
+
+    if (p >= end)
+    {
+        in.pos = in.size;
+        return LexItem(DONE, "", linenum);
+    }
+
+    const char* start = p;
+    char c = *p++;
+    Token token = ERR;
+    string_view lexeme;
+
+    if (IsLetter(c))
+    {
+        while (p < end && (IsLetter(*p) || IsDigit(*p) || *p == '_'))
+            p++;
+        in.pos = p - in.base;
+        LexItem item = id_or_kw(string_view(start, p - start), linenum);
+        if (item == IDENT && in.names != nullptr)
+            return LexItem(IDENT, item.GetLexeme(), linenum, in.names->Intern(item.GetLexeme()));
+        return item;
+    }
+    else if (IsDigit(c))
+    {
+        while (p < end && IsDigit(*p))
+            p++;
+        token = ICONST;
+        if (p + 1 < end && *p == '.' && IsDigit(p[1]))
+        {
+            p++;
+            while (p < end && IsDigit(*p))
+                p++;
+            token = FCONST;
+            if (p < end && (*p == 'e' || *p == 'E'))
+            {
+                const char* q = p + 1;
+                if (q < end && (*q == '+' || *q == '-'))
+                    q++;
+                if (q < end && IsDigit(*q))
+                {
+                    p = q;
+                    while (p < end && IsDigit(*p))
+                        p++;
+                }
+            }
+        }
+        lexeme = string_view(start, p - start);
+    }
+    else if (c == '"')
+    {
+        while (p < end && *p != '"' && *p != '\n')
+            p++;
+        if (p < end && *p == '"')
+        {
+            token = SCONST;
+            lexeme = string_view(start + 1, p - start - 1);
+            p++;
+        }
+        else
+            lexeme = string_view(start, p - start);
+    }
+    else if (c == '\'')
+    {
+        if (p + 1 < end && *p != '\n' && p[1] == '\'')
+        {
+            token = CCONST;
+            lexeme = string_view(p, 1);
+            p += 2;
+        }
+        else
+            lexeme = string_view(start, 1);
+    }
+    else
+    {
+        char next = (p < end) ? *p : '\0';
+        switch (c)
+        {
+            case '+': token = PLUS; break;
+            case '-': token = MINUS; break;
+            case '*': token = (next == '*') ? EXP : MULT; break;
+            case '/': token = (next == '=') ? NEQ : DIV; break;
+            case ':': token = (next == '=') ? ASSOP : COLON; break;
+            case '<': token = (next == '=') ? LTE : LTHAN; break;
+            case '>': token = (next == '=') ? GTE : GTHAN; break;
+            case '=': token = EQ; break;
+            case '&': token = CONCAT; break;
+            case ',': token = COMMA; break;
+            case ';': token = SEMICOL; break;
+            case '(': token = LPAREN; break;
+            case ')': token = RPAREN; break;
+            case '.': token = DOT; break;
+            default: token = ERR; break;
+        }
+        if (token == EXP || token == NEQ || token == ASSOP || token == LTE || token == GTE)
+            p++;
+        lexeme = string_view(start, p - start);
+    }
+
+    in.pos = p - in.base;
+    return LexItem(token, lexeme, linenum);
+}
@@ -0,0 +1,710 @@
+/* Native backend: translate a parsed procedure into a C++ translation unit, build it into a shared object
+   with the system compiler and load it into the interpreter */
+#include <sstream>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <climits>
+#include <cerrno>
+#include <vector>
+#include <dlfcn.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "native.h"
+
+#ifndef SADAL_CXX
+#define SADAL_CXX "c++"
+#endif
+#ifndef SADAL_SOURCE_DIR
+#define SADAL_SOURCE_DIR "."
+#endif
+
+// Start of every generated unit: the interpreter headers, and helpers the translated statements call
+static const char* const Prelude = R"(#include <cmath>
+#include <cstring>
+#include "parserInterp.h"
+#include "treeInterp.h"
+#include "interp.h"
+
+// Report a run-time error; the run stops
+static bool Fail(int line, const char* message)
+{
+    ParseError(line, message);
+    return false;
+}
+
+static bool Uninit(int line, const char* message)
+{
+    ParseError(line, message);
+    ParseError(line, "Invalid reference to a variable.");
+    return false;
+}
+
+// A double with the given bit pattern, for constants that have no literal (infinities, NaNs)
+static inline double Bits(unsigned long long bits)
+{
+    double d;
+    memcpy(&d, &bits, sizeof d);
+    return d;
+}
+)";
+
+// Declared types whose variables and values are held unboxed; strings stay Values
+static bool IsNative(Token type)
+{
+    return type == INT || type == FLOAT || type == BOOL || type == CHAR;
+}
+
+static const char* CType(Token type)
+{
+    switch (type)
+    {
+        case INT: return "int";
+        case FLOAT: return "double";
+        case BOOL: return "bool";
+        case CHAR: return "char";
+        default: return "Value";
+    }
+}
+
+// Value type tag a variable of the declared type accepts, as TypeMatch checks it; null for none
+static const char* TagOf(Token type)
+{
+    switch (type)
+    {
+        case INT: return "VINT";
+        case FLOAT: return "VREAL";
+        case BOOL: return "VBOOL";
+        case STRING: return "VSTRING";
+        case CHAR: return "VCHAR";
+        default: return nullptr;
+    }
+}
+
+static string TokenName(Token type)
+{
+    switch (type)
+    {
+        case INT: return "INT";
+        case FLOAT: return "FLOAT";
+        case BOOL: return "BOOL";
+        case STRING: return "STRING";
+        case CHAR: return "CHAR";
+        default: return "(Token)" + to_string((int)type);
+    }
+}
+
+// C++ string literal with the given contents
+static string Quote(string_view text)
+{
+    string out = "\"";
+    for (unsigned char c : text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            out += '\\';
+            out += (char)c;
+        }
+        else if (c >= 32 && c < 127)
+            out += (char)c;
+        else
+        {
+            char buf[8];
+            snprintf(buf, sizeof buf, "\\%03o", c);
+            out += buf;
+        }
+    }
+    return out + "\"";
+}
+
+static string IntLiteral(int v)
+{
+    if (v == INT_MIN)
+        return "(-2147483647 - 1)";
+    return v < 0 ? "(" + to_string(v) + ")" : to_string(v);
+}
+
+// Hexadecimal literals keep every bit of the constant
+static string RealLiteral(double v)
+{
+    char buf[64];
+    if (isfinite(v))
+        snprintf(buf, sizeof buf, "(%a)", v);
+    else
+    {
+        uint64_t bits;
+        memcpy(&bits, &v, sizeof bits);
+        snprintf(buf, sizeof buf, "Bits(0x%llxull)", (unsigned long long)bits);
+    }
+    return buf;
+}
+
+// C++ code for the value of an expression: of the C++ type of its static type when unboxed, otherwise a Value
+struct Code
+{
+    string text;
+    bool boxed;
+};
+
+// Translates one procedure. Statements become C++ statements in evaluation order, each subexpression
+// landing in a temporary, so errors are reported in the order and at the lines the tree evaluator reports them
+class NativeGen
+{
+    ProgNode* prog;
+    ostringstream consts;
+    ostringstream body;
+    int depth = 1;
+    int temps = 0;
+    int strings = 0;
+
+    ostream& Line() { return body << string(4 * depth, ' '); }
+    string Temp() { return "t" + to_string(temps++); }
+
+    static string Var(int slot) { return "v" + to_string(slot); }
+    static string Set(int slot) { return "set" + to_string(slot); }
+
+    // The value as the C++ type of a proven static type
+    static string Unboxed(const Code& code, Token type)
+    {
+        if (!code.boxed)
+            return code.text;
+        switch (type)
+        {
+            case INT: return code.text + ".GetInt()";
+            case FLOAT: return code.text + ".GetReal()";
+            case BOOL: return code.text + ".GetBool()";
+            case CHAR: return code.text + ".GetChar()";
+            default: return code.text;
+        }
+    }
+
+    static string Boxed(const Code& code)
+    {
+        return code.boxed ? code.text : "Value(" + code.text + ")";
+    }
+
+    void Open()
+    {
+        Line() << "{" << endl;
+        depth++;
+    }
+
+    void Close()
+    {
+        depth--;
+        Line() << "}" << endl;
+    }
+
+    void Fail(int line, const string& message)
+    {
+        Line() << "return Fail(" << line << ", " << Quote(message) << ");" << endl;
+    }
+
+    Code Const(const Value& val);
+    Code Name(NameNode* name);
+    Code Unary(UnaryNode* unary);
+    Code Binary(BinaryNode* binary);
+    Code Expr(ExprNode* expr);
+
+    void Store(int slot, const Code& val, Token type);
+    void Assign(const vector<int>& slots, Token type, ExprNode* expr, int line, const char* error);
+    string Condition(ExprNode* cond, const char* typeError, const char* stmtError);
+    void Print(PrintNode* print);
+    void Get(GetNode* get);
+    void If(IfNode* ifNode, size_t arm);
+    void While(WhileNode* loop);
+    void For(ForNode* loop);
+    void Stmts(const vector<StmtNode*>& stmts);
+
+public:
+    explicit NativeGen(ProgNode* prog) : prog(prog) {}
+
+    void Emit(ostream& out);
+};
+
+Code NativeGen::Const(const Value& val)
+{
+    switch (val.GetType())
+    {
+        case VINT: return { IntLiteral(val.GetInt()), false };
+        case VREAL: return { RealLiteral(val.GetReal()), false };
+        case VBOOL: return { val.GetBool() ? "true" : "false", false };
+        case VCHAR: return { "(char)" + to_string((int)val.GetChar()), false };
+        case VSTRING:
+        {
+            // Built once when the object is loaded, then shared by every run like a constant node's value
+            string name = "k" + to_string(strings++);
+            string_view text = val.GetString();
+            consts << "static const Value " << name << "(string(" << Quote(text) << ", " << text.size() << "));" << endl;
+            return { name, true };
+        }
+        default:
+            return { "Value()", true };
+    }
+}
+
+// A variable reference reads the variable in place; indexing and slicing go through the interpreter's checks
+Code NativeGen::Name(NameNode* name)
+{
+    int slot = name->slot;
+    int line = name->line;
+    Token type = prog->varTypes[slot];
+    string var = Var(slot);
+
+    Line() << "if (" << (IsNative(type) ? "!" + Set(slot) : var + ".IsErr()") << ") return Uninit(" << line << ", "
+           << Quote("Run-Time Error-Using uninitialized variable" + prog->varNames[slot]) << ");" << endl;
+    if (name->index1 == nullptr)
+        return { var, !IsNative(type) };
+
+    if (IsNative(type))
+        Fail(line, "Run-Time Error-Indexing a non-string variable");
+    else
+    {
+        Line() << "if (!" << var << ".IsString()) return Fail(" << line << ", "
+               << Quote("Run-Time Error-Indexing a non-string variable") << ");" << endl;
+    }
+
+    string result = Temp();
+    Code index1 = Expr(name->index1);
+    Line() << "Value " << result << ";" << endl;
+    if (name->index2 == nullptr)
+    {
+        Line() << "if (!IndexString(" << var << ", " << Boxed(index1) << ", " << line << ", "
+               << result << ")) return false;" << endl;
+        return { result, true };
+    }
+
+    Code index2 = Expr(name->index2);
+    Line() << "if (!SliceString(" << var << ", " << Boxed(index1) << ", " << Boxed(index2) << ", " << line << ", "
+           << result << ")) return false;" << endl;
+    return { result, true };
+}
+
+Code NativeGen::Unary(UnaryNode* unary)
+{
+    Code operand = Expr(unary->operand);
+    string result = Temp();
+
+    if (unary->type != ERR)
+    {
+        string val = Unboxed(operand, unary->operand->type);
+        if (unary->op == NOT)
+            Line() << "bool " << result << " = !" << val << ";" << endl;
+        else if (unary->type == INT)
+            Line() << "int " << result << " = IntNeg(" << val << ");" << endl;
+        else
+            Line() << "double " << result << " = -" << val << ";" << endl;
+        return { result, false };
+    }
+
+    if (unary->op == MINUS)
+    {
+        Line() << "Value " << result << ";" << endl;
+        Line() << "if (!Negate(" << Boxed(operand) << ", " << unary->line << ", " << result << ")) return false;" << endl;
+    }
+    else
+        Line() << "Value " << result << " = !" << Boxed(operand) << ";" << endl;
+    return { result, true };
+}
+
+// An operator on unboxed operands of the static types left and right, computed as the Value operator would.
+// Integer arithmetic goes through the wrapping helpers in val.h, as in every engine
+static string UnboxedBinary(Token op, Token left, Token right, const string& a, const string& b)
+{
+    bool ints = left == INT && right == INT;
+    bool same = left == right;
+    switch (op)
+    {
+        case PLUS: return ints ? "IntAdd(" + a + ", " + b + ")" : a + " + " + b;
+        case MINUS: return ints ? "IntSub(" + a + ", " + b + ")" : a + " - " + b;
+        case MULT: return ints ? "IntMul(" + a + ", " + b + ")" : a + " * " + b;
+        case DIV: return ints ? "IntDiv(" + a + ", " + b + ")" : a + " / " + b;
+        case MOD: return "IntMod(" + a + ", " + b + ")";
+        case EXP: return "pow((double)" + a + ", (double)" + b + ")";
+        case AND: return a + " && " + b;
+        case OR: return a + " || " + b;
+        // Values of different types are never equal, and <= only adds equality to <
+        case EQ: return same ? a + " == " + b : "false";
+        case NEQ: return same ? a + " != " + b : "true";
+        case LTHAN: return a + " < " + b;
+        case LTE: return same ? a + " <= " + b : a + " < " + b;
+        case GTHAN: return same ? "!(" + a + " <= " + b + ")" : "!(" + a + " < " + b + ")";
+        case GTE: return "!(" + a + " < " + b + ")";
+        default: return "false";
+    }
+}
+
+static string BoxedBinary(Token op, const string& a, const string& b)
+{
+    switch (op)
+    {
+        case AND: return a + " && " + b;
+        case OR: return a + " || " + b;
+        case EQ: return a + " == " + b;
+        case NEQ: return a + " != " + b;
+        case LTHAN: return a + " < " + b;
+        case LTE: return a + " <= " + b;
+        case GTHAN: return a + " > " + b;
+        case GTE: return a + " >= " + b;
+        case PLUS: return a + " + " + b;
+        case MINUS: return a + " - " + b;
+        case CONCAT: return a + ".Concat(" + b + ")";
+        case MULT: return a + " * " + b;
+        case DIV: return a + " / " + b;
+        case MOD: return a + " % " + b;
+        case EXP: return a + ".Exp(" + b + ")";
+        default: return "Value()";
+    }
+}
+
+// Operators on proven numbers and booleans compute unboxed; the rest apply the Value operators
+Code NativeGen::Binary(BinaryNode* binary)
+{
+    Code left = Expr(binary->left);
+    Code right = Expr(binary->right);
+    Token lt = binary->left->type, rt = binary->right->type;
+    Token op = binary->op;
+    string result = Temp();
+
+    if (binary->type != ERR && IsNative(lt) && IsNative(rt))
+    {
+        Line() << CType(binary->type) << " " << result << " = "
+               << UnboxedBinary(op, lt, rt, Unboxed(left, lt), Unboxed(right, rt)) << ";" << endl;
+        return { result, false };
+    }
+
+    if ((op == EQ || op == NEQ) && lt != ERR && rt != ERR)
+    {
+        string eq = (op == EQ) ? "false" : "true";
+        if (lt == STRING && rt == STRING)
+            eq = left.text + ".GetString() " + (op == EQ ? "==" : "!=") + " " + right.text + ".GetString()";
+        Line() << "bool " << result << " = " << eq << ";" << endl;
+        return { result, false };
+    }
+
+    Line() << "Value " << result << " = " << BoxedBinary(op, Boxed(left), Boxed(right)) << ";" << endl;
+    if (binary->type == ERR)
+        Line() << "if (" << result << ".IsErr() && Raised(" << result << ", " << binary->line << ")) return false;" << endl;
+    return { result, true };
+}
+
+Code NativeGen::Expr(ExprNode* expr)
+{
+    switch (expr->kind)
+    {
+        case CONST_NODE: return Const(static_cast<ConstNode*>(expr)->val);
+        case NAME_NODE: return Name(static_cast<NameNode*>(expr));
+        case UNARY_NODE: return Unary(static_cast<UnaryNode*>(expr));
+        case BINARY_NODE: return Binary(static_cast<BinaryNode*>(expr));
+        default: return { "Value()", true };
+    }
+}
+
+// Store a value of static type type, or of the variable's type when checked at run time, into a variable
+void NativeGen::Store(int slot, const Code& val, Token type)
+{
+    Token varType = prog->varTypes[slot];
+    if (IsNative(varType))
+        Line() << Var(slot) << " = " << Unboxed(val, type) << "; " << Set(slot) << " = true;" << endl;
+    else
+        Line() << Var(slot) << " = " << Boxed(val) << ";" << endl;
+}
+
+// Evaluate a declaration initializer or assignment expression, check its type and store it in every slot
+void NativeGen::Assign(const vector<int>& slots, Token type, ExprNode* expr, int line, const char* error)
+{
+    Code val = Expr(expr);
+    const char* tag = TagOf(type);
+    if (tag == nullptr || (expr->type != ERR && expr->type != type))
+    {
+        Fail(line, error);
+        return;
+    }
+    if (expr->type == ERR)
+    {
+        Line() << "if (" << val.text << ".GetType() != " << tag << ") return Fail(" << line << ", " << Quote(error)
+               << ");" << endl;
+    }
+
+    for (int slot : slots)
+        Store(slot, val, type);
+}
+
+// Evaluate a condition and check it is boolean, giving the C++ condition to test
+string NativeGen::Condition(ExprNode* cond, const char* typeError, const char* stmtError)
+{
+    int line = cond->line;
+    Code val = Expr(cond);
+    if (cond->type == BOOL)
+        return Unboxed(val, BOOL);
+
+    if (cond->type == ERR)
+        Line() << "if (" << val.text << ".GetType() != VBOOL)" << endl;
+    Open();
+    Line() << "ParseError(" << line << ", " << Quote(typeError) << ");" << endl;
+    Fail(line, stmtError);
+    Close();
+    return cond->type == ERR ? val.text + ".GetBool()" : "false";
+}
+
+void NativeGen::Print(PrintNode* print)
+{
+    Code val = Expr(print->expr);
+    if (print->expr->type == BOOL && !val.boxed)
+        Line() << "out << (" << val.text << " ? \"true\" : \"false\");" << endl;
+    else
+        Line() << "out << " << val.text << ";" << endl;
+    if (print->newline)
+        Line() << "out << '\\n';" << endl;
+}
+
+// Input leaves the variable unchanged when the type reads as nothing
+void NativeGen::Get(GetNode* get)
+{
+    string val = Temp();
+    Line() << "Value " << val << ";" << endl;
+    Line() << "if (!ReadValue(" << TokenName(get->type) << ", " << get->line << ", " << val << ")) return false;" << endl;
+    Line() << "if (!" << val << ".IsErr())" << endl;
+    Open();
+    Store(get->slot, { val, true }, prog->varTypes[get->slot]);
+    Close();
+}
+
+// Arm arm of an IF and the arms after it: each ELSIF condition is only evaluated when the ones before are false
+void NativeGen::If(IfNode* ifNode, size_t arm)
+{
+    if (arm == ifNode->arms.size())
+    {
+        Stmts(ifNode->elseBody);
+        return;
+    }
+
+    string cond = Condition(ifNode->arms[arm].cond,
+        arm == 0 ? "Missing if statement condition" : "Invalid expression type for an Elsif condition",
+        "Invalid If statement.");
+    Line() << "if (" << cond << ")" << endl;
+    Open();
+    Stmts(ifNode->arms[arm].body);
+    Close();
+    if (arm + 1 == ifNode->arms.size() && ifNode->elseBody.empty())
+        return;
+    Line() << "else" << endl;
+    Open();
+    If(ifNode, arm + 1);
+    Close();
+}
+
+void NativeGen::While(WhileNode* loop)
+{
+    Line() << "while (true)" << endl;
+    Open();
+    string cond = Condition(loop->cond, "Invalid expression type for a While condition", "Invalid While statement.");
+    Line() << "if (!(" << cond << ")) break;" << endl;
+    Stmts(loop->body);
+    Close();
+}
+
+// Both bounds are evaluated once; the loop stops at the upper bound without stepping past it
+void NativeGen::For(ForNode* loop)
+{
+    Code low = Expr(loop->low);
+    Code high = Expr(loop->high);
+    Token lowType = loop->low->type, highType = loop->high->type;
+
+    string check;
+    for (auto [bound, type] : { make_pair(&low, lowType), make_pair(&high, highType) })
+    {
+        if (type == INT)
+            continue;
+        if (type != ERR)
+        {
+            check = "true";
+            break;
+        }
+        check += (check.empty() ? "!" : " || !") + bound->text + ".IsInt()";
+    }
+    if (check == "true")
+        Fail(loop->line, "Run-Time Error-Non-integer bounds in For loop range");
+    else if (!check.empty())
+    {
+        Line() << "if (" << check << ") return Fail(" << loop->line << ", "
+               << Quote("Run-Time Error-Non-integer bounds in For loop range") << ");" << endl;
+    }
+
+    string i = Temp(), last = Temp();
+    Line() << "int " << last << " = " << (highType == INT || highType == ERR ? Unboxed(high, INT) : "0") << ";" << endl;
+    Line() << "for (int " << i << " = " << (lowType == INT || lowType == ERR ? Unboxed(low, INT) : "0") << "; "
+           << i << " <= " << last << "; " << i << "++)" << endl;
+    Open();
+    Store(loop->slot, { i, false }, INT);
+    Stmts(loop->body);
+    Line() << "if (" << i << " == " << last << ") break;" << endl;
+    Close();
+}
+
+// Each statement gets a block of its own, so its temporaries end with it
+void NativeGen::Stmts(const vector<StmtNode*>& stmts)
+{
+    for (StmtNode* stmt : stmts)
+    {
+        if (stmt->kind == DECL_NODE && static_cast<DeclNode*>(stmt)->init == nullptr)
+            continue;
+
+        Open();
+        switch (stmt->kind)
+        {
+            case DECL_NODE:
+            {
+                DeclNode* decl = static_cast<DeclNode*>(stmt);
+                Assign(decl->slots, decl->type, decl->init, decl->line, "Run-Time Error - Illegal Assignment Operation");
+                break;
+            }
+            case ASSIGN_NODE:
+            {
+                AssignNode* assign = static_cast<AssignNode*>(stmt);
+                Assign({ assign->slot }, assign->type, assign->expr, assign->line, "Run-Time Error-Illegal Assignment Operation");
+                break;
+            }
+            case PRINT_NODE: Print(static_cast<PrintNode*>(stmt)); break;
+            case GET_NODE: Get(static_cast<GetNode*>(stmt)); break;
+            case IF_NODE: If(static_cast<IfNode*>(stmt), 0); break;
+            case WHILE_NODE: While(static_cast<WhileNode*>(stmt)); break;
+            case FOR_NODE: For(static_cast<ForNode*>(stmt)); break;
+            default: break;
+        }
+        Close();
+    }
+}
+
+// Variables are locals of the run: unboxed ones with a flag telling whether they were assigned, the rest
+// Values that start out unassigned. They are destroyed before the run's string pool is reset
+void NativeGen::Emit(ostream& out)
+{
+    Stmts(prog->decls);
+    Stmts(prog->body);
+
+    out << "// Procedure " << prog->name << ", translated to C++ by the native backend" << endl;
+    out << Prelude << endl;
+    out << consts.str();
+    out << endl << "static bool Run()" << endl << "{" << endl;
+    out << "    OutputSink& out = *Ctx->Sink;" << endl;
+    for (int slot = 0; slot < prog->NumSlots(); slot++)
+    {
+        Token type = prog->varTypes[slot];
+        out << "    ";
+        if (IsNative(type))
+            out << CType(type) << " " << Var(slot) << " = 0; bool " << Set(slot) << " = false;";
+        else
+            out << "Value " << Var(slot) << ";";
+        out << "    // " << prog->varNames[slot] << endl;
+    }
+    out << body.str();
+    out << "    return true;" << endl << "}" << endl << endl;
+    out << "extern \"C\" bool " << NATIVE_ENTRY << "()" << endl << "{" << endl;
+    out << "    StringPoolScope strings(Ctx->Strings);" << endl;
+    out << "    return Run();" << endl << "}" << endl;
+}
+
+// Write the C++ translation unit of a parsed procedure
+void EmitNative(ProgNode* prog, ostream& out)
+{
+    NativeGen(prog).Emit(out);
+}
+
+// Translate a procedure and build it into a shared object with the compiler the interpreter was built with,
+// against the interpreter's own headers. The compiler's messages go to log
+bool BuildNative(ProgNode* prog, const string& object, string& log)
+{
+    string source = object + ".cpp";
+    {
+        ofstream out(source);
+        if (!out)
+        {
+            log = "cannot write " + source;
+            return false;
+        }
+        EmitNative(prog, out);
+    }
+
+    // The compiler runs directly, not through a shell, so the paths reach it as they are whatever they contain.
+    // Everything it prints comes back through one pipe
+    string include = "-I" SADAL_SOURCE_DIR;
+    const string failed = "cannot run " SADAL_CXX "\n";
+    vector<const char*> args = { SADAL_CXX, "-std=c++17", "-O2", "-shared", "-fPIC", include.c_str(),
+        "-o", object.c_str(), source.c_str(), nullptr };
+    int fds[2];
+    if (pipe(fds) != 0)
+    {
+        log = failed;
+        remove(source.c_str());
+        return false;
+    }
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        dup2(fds[1], STDOUT_FILENO);
+        dup2(fds[1], STDERR_FILENO);
+        close(fds[0]);
+        close(fds[1]);
+        execvp(args[0], const_cast<char* const*>(args.data()));
+        ssize_t ignored = write(STDERR_FILENO, failed.data(), failed.size());
+        (void)ignored;
+        _exit(127);
+    }
+    close(fds[1]);
+    if (pid < 0)
+    {
+        close(fds[0]);
+        log = failed;
+        remove(source.c_str());
+        return false;
+    }
+
+    char buf[4096];
+    ssize_t n;
+    log.clear();
+    while ((n = read(fds[0], buf, sizeof buf)) != 0)
+    {
+        if (n > 0)
+            log.append(buf, n);
+        else if (errno != EINTR)
+            break;
+    }
+    close(fds[0]);
+
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0 && errno == EINTR)
+        ;
+    remove(source.c_str());
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+NativeProgram::~NativeProgram()
+{
+    if (handle != nullptr)
+        dlclose(handle);
+}
+
+// Load a built procedure; a path without a slash names a file in the current directory, not a library to search for
+bool NativeProgram::Load(const string& object, string& error)
+{
+    string path = object.find('/') == string::npos ? "./" + object : object;
+    handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (handle == nullptr)
+    {
+        error = dlerror();
+        return false;
+    }
+
+    entry = reinterpret_cast<bool (*)()>(dlsym(handle, NATIVE_ENTRY));
+    if (entry == nullptr)
+    {
+        error = object + " has no " NATIVE_ENTRY " entry point";
+        dlclose(handle);
+        handle = nullptr;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,38 @@
+/* Output sinks for PUT, PUTLN and error reports */
+#include <cerrno>
+#include <unistd.h>
+#include "output.h"
+
+FileSink StdOut(1);
+
+void FileSink::Emit(const char* data, size_t n)
+{
+    while (n > 0)
+    {
+        ssize_t written = write(fd, data, n);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return;
+        }
+        data += written;
+        n -= written;
+    }
+}
+
+void StreamSink::Emit(const char* data, size_t n)
+{
+    out.write(data, n);
+}
+
+void StreamSink::Flush()
+{
+    OutputSink::Flush();
+    out.flush();
+}
+
+void StringSink::Emit(const char* data, size_t n)
+{
+    text.append(data, n);
+}
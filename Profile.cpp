@@ -0,0 +1,132 @@
+/* Per-statement profiler: aggregation by line and statement kind, text and JSON reports */
+#include <iomanip>
+#include <map>
+#include <algorithm>
+#include "profile.h"
+
+// Names of the parser functions that build each statement kind
+static const char* KindName(NodeKind kind)
+{
+    switch (kind)
+    {
+        case DECL_NODE: return "DeclStmt";
+        case ASSIGN_NODE: return "AssignStmt";
+        case PRINT_NODE: return "PrintStmts";
+        case GET_NODE: return "GetStmt";
+        case IF_NODE: return "IfStmt";
+        case WHILE_NODE: return "WhileStmt";
+        case FOR_NODE: return "ForStmt";
+        default: return "?";
+    }
+}
+
+// Label of branch arm of a statement with the given number of branches: the IF arms, ELSE last
+static string ArmName(NodeKind kind, size_t arm, size_t arms)
+{
+    if (kind == WHILE_NODE)
+        return "loop";
+    if (arm == 0)
+        return "if";
+    if (arm + 1 == arms)
+        return "else";
+    return "elsif " + to_string(arm);
+}
+
+struct Profiler::Row
+{
+    int line;
+    NodeKind kind;
+    Entry stats;
+};
+
+vector<Profiler::Row> Profiler::Rows() const
+{
+    map<pair<int, NodeKind>, Entry> merged;
+    for (auto& [stmt, entry] : entries)
+    {
+        Entry& row = merged[{ stmt->line, stmt->kind }];
+        row.count += entry.count;
+        row.totalNs += entry.totalNs;
+        row.selfNs += entry.selfNs;
+        size_t arms = entry.branches.size();
+        if (stmt->kind == IF_NODE)
+            arms = static_cast<const IfNode*>(stmt)->arms.size() + 1;
+        if (row.branches.size() < arms)
+            row.branches.resize(arms);
+        for (size_t i = 0; i < entry.branches.size(); i++)
+        {
+            row.branches[i].taken += entry.branches[i].taken;
+            row.branches[i].skipped += entry.branches[i].skipped;
+        }
+    }
+
+    vector<Row> rows;
+    for (auto& [key, entry] : merged)
+        rows.push_back(Row{ key.first, key.second, entry });
+    stable_sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) { return a.stats.selfNs > b.stats.selfNs; });
+    return rows;
+}
+
+// Statements executed in all
+uint64_t Profiler::Executed() const
+{
+    uint64_t count = 0;
+    for (auto& [stmt, entry] : entries)
+        count += entry.count;
+    return count;
+}
+
+void Profiler::Report(ostream& out) const
+{
+    vector<Row> rows = Rows();
+    uint64_t totalSelf = 0, executed = 0;
+    for (const Row& row : rows)
+    {
+        totalSelf += row.stats.selfNs;
+        executed += row.stats.count;
+    }
+
+    out << "; profile: " << executed << " statements executed, " << fixed << setprecision(3)
+        << totalSelf / 1e6 << " ms" << endl;
+    out << setw(6) << "line" << "  " << left << setw(12) << "statement" << right << setw(12) << "count"
+        << setw(12) << "total ms" << setw(12) << "self ms" << setw(8) << "self %" << endl;
+    for (const Row& row : rows)
+    {
+        out << setw(6) << row.line << "  " << left << setw(12) << KindName(row.kind) << right
+            << setw(12) << row.stats.count << setprecision(3) << setw(12) << row.stats.totalNs / 1e6
+            << setw(12) << row.stats.selfNs / 1e6 << setprecision(1) << setw(8)
+            << (totalSelf ? 100.0 * row.stats.selfNs / totalSelf : 0.0);
+        const vector<Branch>& branches = row.stats.branches;
+        for (size_t i = 0; i < branches.size(); i++)
+        {
+            out << (i == 0 ? "  " : ", ") << ArmName(row.kind, i, branches.size()) << " " << branches[i].taken
+                << "/" << branches[i].taken + branches[i].skipped;
+        }
+        out << endl;
+    }
+}
+
+void Profiler::WriteJson(ostream& out) const
+{
+    out << "[" << endl;
+    vector<Row> rows = Rows();
+    for (size_t r = 0; r < rows.size(); r++)
+    {
+        const Row& row = rows[r];
+        out << "  {\"line\": " << row.line << ", \"kind\": \"" << KindName(row.kind) << "\", \"count\": "
+            << row.stats.count << ", \"total_ns\": " << row.stats.totalNs << ", \"self_ns\": " << row.stats.selfNs;
+        const vector<Branch>& branches = row.stats.branches;
+        if (!branches.empty())
+        {
+            out << ", \"branches\": [";
+            for (size_t i = 0; i < branches.size(); i++)
+            {
+                out << (i ? ", " : "") << "{\"arm\": \"" << ArmName(row.kind, i, branches.size())
+                    << "\", \"taken\": " << branches[i].taken << ", \"skipped\": " << branches[i].skipped << "}";
+            }
+            out << "]";
+        }
+        out << "}" << (r + 1 < rows.size() ? "," : "") << endl;
+    }
+    out << "]" << endl;
+}
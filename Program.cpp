@@ -0,0 +1,484 @@
+/* Embedding API: compile-once, run-many entry points and the compiled program cache */
+#include <thread>
+#include <atomic>
+#include <deque>
+#include <condition_variable>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include "parserInterp.h"
+#include "interp.h"
+#include "program.h"
+
+// Parse and compile source text, collecting error reports instead of printing them
+CompiledProgram Compile(string_view source)
+{
+    CompiledProgram compiled;
+    StringSink diagnostics;
+    Interp ctx;
+    ctx.Sink = &diagnostics;
+    InterpScope scope(ctx);
+
+    LexBuffer src{string(source)};
+    int line = 1;
+    ProgNode* prog = nullptr;
+    if (ParseProg(src, line, prog))
+    {
+        compiled.ok = CompileProg(prog, compiled.chunk);
+        delete prog;
+    }
+
+    compiled.errors = ctx.error_count;
+    compiled.diagnostics = diagnostics.Text();
+    return compiled;
+}
+
+// Execute a compiled program against the given input and sink in a context of its own
+bool Run(const CompiledProgram& prog, InputSource& input, OutputSink& output)
+{
+    if (!prog.ok)
+        return false;
+
+    Interp ctx;
+    ctx.Input = &input;
+    ctx.Sink = &output;
+    InterpScope scope(ctx);
+    bool status = RunChunk(prog.chunk, prog.tier.Enter(prog.chunk));
+    output.Flush();
+    return status;
+}
+
+bool Run(const CompiledProgram& prog, istream& input, ostream& output)
+{
+    InputSource source(input);
+    StreamSink sink(output);
+    return Run(prog, source, sink);
+}
+
+// Whole input lines and the span of each record in them: lines with their "\r" trimmed, blank ones left out
+struct RecordBlock
+{
+    string text;
+    vector<pair<size_t, size_t>> records;
+    bool last = false;
+};
+
+// Blocks pass from the reader to the executor filled and come back empty. A fixed set circulates
+class BlockQueue
+{
+    mutex guard;
+    condition_variable changed;
+    deque<RecordBlock*> filled, empty;
+
+    static RecordBlock* Pop(deque<RecordBlock*>& blocks)
+    {
+        RecordBlock* block = blocks.front();
+        blocks.pop_front();
+        return block;
+    }
+
+public:
+    void Put(RecordBlock* block, bool full)
+    {
+        {
+            lock_guard<mutex> lock(guard);
+            (full ? filled : empty).push_back(block);
+        }
+        changed.notify_one();
+    }
+
+    RecordBlock* Take(bool full)
+    {
+        deque<RecordBlock*>& blocks = full ? filled : empty;
+        unique_lock<mutex> lock(guard);
+        changed.wait(lock, [&] { return !blocks.empty(); });
+        return Pop(blocks);
+    }
+
+    // A filled block if one is ready, without waiting
+    RecordBlock* Poll()
+    {
+        lock_guard<mutex> lock(guard);
+        return filled.empty() ? nullptr : Pop(filled);
+    }
+};
+
+static const int StreamBlocks = 4;
+static const size_t StreamReadSize = 1 << 16;
+
+// Reader thread: fill each empty block with the complete lines read so far, carrying a partial last line
+// over to the next block. read returns the bytes it read, 0 at the end of the input
+template <class Read>
+static void ReadRecords(Read read, BlockQueue& queue)
+{
+    string carry;
+    bool eof = false;
+    while (!eof)
+    {
+        RecordBlock* block = queue.Take(false);
+        string& text = block->text;
+        text.assign(carry);
+        block->records.clear();
+
+        // Read until the block holds at least one whole line. A trickle of input is handed over line by line,
+        // a bulk read as whole buffers of lines
+        size_t lastLine = string::npos;
+        while (lastLine == string::npos && !eof)
+        {
+            size_t old = text.size();
+            text.resize(old + StreamReadSize);
+            size_t n = read(&text[old], StreamReadSize);
+            text.resize(old + n);
+            eof = (n == 0);
+            size_t found = string_view(text).substr(old).rfind('\n');
+            if (found != string::npos)
+                lastLine = old + found;
+        }
+
+        size_t used = eof ? text.size() : lastLine + 1;
+        carry.assign(text, used, string::npos);
+        text.resize(used);
+
+        SplitRecords(text, [&](string_view record) { block->records.push_back({ record.data() - text.data(), record.size() }); });
+
+        block->last = eof;
+        queue.Put(block, true);
+    }
+}
+
+// Run the records on the calling thread as the reader hands them over. Output is flushed whenever the
+// executor catches up with the reader, so a slow stream sees each record's output as it is produced
+template <class Read>
+static StreamStats Stream(const CompiledProgram& prog, Read read, OutputSink& output)
+{
+    StreamStats stats;
+    if (!prog.ok)
+        return stats;
+
+    BlockQueue queue;
+    RecordBlock blocks[StreamBlocks];
+    for (RecordBlock& block : blocks)
+        queue.Put(&block, false);
+    thread reader([&] { ReadRecords(read, queue); });
+
+    Interp ctx;
+    ctx.Sink = &output;
+    InterpScope scope(ctx);
+    bool last = false;
+    while (!last)
+    {
+        RecordBlock* block = queue.Poll();
+        if (block == nullptr)
+        {
+            output.Flush();
+            block = queue.Take(true);
+        }
+
+        for (auto [start, len] : block->records)
+        {
+            InputSource fields(string_view(block->text).substr(start, len));
+            ctx.Input = &fields;
+            if (!RunChunk(prog.chunk, prog.tier.Enter(prog.chunk)))
+                stats.failed++;
+            stats.records++;
+        }
+        last = block->last;
+        queue.Put(block, false);
+    }
+
+    reader.join();
+    output.Flush();
+    stats.errors = ctx.error_count;
+    return stats;
+}
+
+StreamStats RunStream(const CompiledProgram& prog, int fd, OutputSink& output)
+{
+    return Stream(prog, [fd](char* buf, size_t size) -> size_t
+    {
+        ssize_t n;
+        do
+            n = read(fd, buf, size);
+        while (n < 0 && errno == EINTR);
+        return n < 0 ? 0 : (size_t)n;
+    }, output);
+}
+
+// A stream is read in whole buffers, so this form suits files and bulk input rather than a live feed
+StreamStats RunStream(const CompiledProgram& prog, istream& input, ostream& output)
+{
+    StreamSink sink(output);
+    return Stream(prog, [&input](char* buf, size_t size) -> size_t
+    {
+        input.read(buf, size);
+        return (size_t)input.gcount();
+    }, sink);
+}
+
+// Task IDs dealt to one worker: its owner takes them from the front, in input order, and idle workers
+// steal from the back, the part of the input furthest from being written out
+struct alignas(64) TaskDeque
+{
+    mutex guard;
+    vector<size_t> tasks;
+    size_t front = 0;
+    size_t back = 0;
+
+    bool TakeFront(size_t& task)
+    {
+        lock_guard<mutex> lock(guard);
+        if (front == back)
+            return false;
+        task = tasks[front++];
+        return true;
+    }
+
+    bool TakeBack(size_t& task)
+    {
+        lock_guard<mutex> lock(guard);
+        if (front == back)
+            return false;
+        task = tasks[--back];
+        return true;
+    }
+};
+
+static const size_t TaskBytes = 1 << 16;
+
+// The input is cut into tasks of about TaskBytes of whole lines, dealt round robin so that the workers move
+// through the input side by side. A task's output is kept until every task before it has been written
+StreamStats RunParallel(const CompiledProgram& prog, string_view input, OutputSink& output, unsigned workers)
+{
+    StreamStats stats;
+    if (!prog.ok)
+        return stats;
+
+    vector<string_view> tasks;
+    for (size_t start = 0; start < input.size();)
+    {
+        size_t stop = input.find('\n', min(input.size(), start + TaskBytes));
+        stop = (stop == string_view::npos) ? input.size() : stop + 1;
+        tasks.push_back(input.substr(start, stop - start));
+        start = stop;
+    }
+
+    if (workers == 0)
+        workers = max(1u, thread::hardware_concurrency());
+    workers = (unsigned)max<size_t>(1, min<size_t>(workers, tasks.size()));
+
+    vector<TaskDeque> deques(workers);
+    for (size_t t = 0; t < tasks.size(); t++)
+        deques[t % workers].tasks.push_back(t);
+    for (TaskDeque& deque : deques)
+        deque.back = deque.tasks.size();
+
+    vector<string> results(tasks.size());
+    vector<char> done(tasks.size(), false);
+    size_t written = 0;
+    mutex writing;
+    atomic<uint64_t> records{0}, failed{0};
+    atomic<int> errors{0};
+
+    auto worker = [&](unsigned self)
+    {
+        Interp ctx;
+        StringSink sink;
+        ctx.Sink = &sink;
+        InterpScope scope(ctx);
+        const JitCode* jit = nullptr;
+        uint64_t ran = 0, fails = 0;
+
+        size_t task;
+        while (true)
+        {
+            bool found = deques[self].TakeFront(task);
+            for (unsigned k = 1; !found && k < workers; k++)
+                found = deques[(self + k) % workers].TakeBack(task);
+            if (!found)
+                break;
+
+            SplitRecords(tasks[task], [&](string_view record)
+            {
+                InputSource fields(record);
+                ctx.Input = &fields;
+                // Count runs toward the JIT threshold only until the code exists, so workers stop sharing the counter
+                if (jit == nullptr)
+                    jit = prog.tier.Enter(prog.chunk);
+                if (!RunChunk(prog.chunk, jit))
+                    fails++;
+                ran++;
+            });
+            results[task] = sink.Take();
+
+            // Whoever completes the next task to write writes it, and every finished one after it
+            lock_guard<mutex> lock(writing);
+            done[task] = true;
+            for (; written < tasks.size() && done[written]; written++)
+            {
+                output << results[written];
+                string().swap(results[written]);
+            }
+        }
+
+        records += ran;
+        failed += fails;
+        errors += ctx.error_count;
+    };
+
+    vector<thread> pool;
+    for (unsigned w = 1; w < workers; w++)
+        pool.emplace_back(worker, w);
+    worker(0);
+    for (thread& t : pool)
+        t.join();
+
+    output.Flush();
+    stats.records = records;
+    stats.failed = failed;
+    stats.errors = errors;
+    return stats;
+}
+
+// 64-bit FNV-1a hash of source text
+uint64_t SourceHash(string_view source)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : source)
+    {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// Look up a cached program and mark it most recently used. Caller holds the lock
+shared_ptr<const CompiledProgram> ProgramCache::Find(uint64_t hash, string_view source)
+{
+    auto range = index.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        if (it->second->source == source)
+        {
+            entries.splice(entries.begin(), entries, it->second);
+            return it->second->prog;
+        }
+    }
+    return nullptr;
+}
+
+// Return the compiled program for source, compiling it on a miss. Failed compilations are cached too
+shared_ptr<const CompiledProgram> ProgramCache::Get(string_view source)
+{
+    uint64_t hash = SourceHash(source);
+    {
+        lock_guard<mutex> lock(guard);
+        if (auto found = Find(hash, source))
+        {
+            hits++;
+            return found;
+        }
+    }
+
+    // Compile without holding the lock; if another thread cached the same source meanwhile, use its copy
+    auto prog = make_shared<const CompiledProgram>(Compile(source));
+    lock_guard<mutex> lock(guard);
+    if (auto found = Find(hash, source))
+    {
+        hits++;
+        return found;
+    }
+
+    misses++;
+    entries.push_front(Entry{string(source), prog});
+    index.emplace(hash, entries.begin());
+
+    while (entries.size() > capacity && entries.size() > 1)
+    {
+        auto last = prev(entries.end());
+        auto bucket = index.equal_range(SourceHash(last->source));
+        for (auto it = bucket.first; it != bucket.second; ++it)
+        {
+            if (it->second == last)
+            {
+                index.erase(it);
+                break;
+            }
+        }
+        entries.pop_back();
+    }
+    return prog;
+}
+
+void ProgramCache::Clear()
+{
+    lock_guard<mutex> lock(guard);
+    entries.clear();
+    index.clear();
+}
+
+// Counts read under the lock, as Get updates them
+size_t ProgramCache::Size() const
+{
+    lock_guard<mutex> lock(guard);
+    return entries.size();
+}
+
+size_t ProgramCache::Hits() const
+{
+    lock_guard<mutex> lock(guard);
+    return hits;
+}
+
+size_t ProgramCache::Misses() const
+{
+    lock_guard<mutex> lock(guard);
+    return misses;
+}
+
+// Run every job on a fixed pool of worker threads, each claiming the next unstarted job.
+// Jobs sharing a source compile it once through the cache
+vector<BatchResult> RunBatch(const vector<BatchJob>& jobs, unsigned workers, ProgramCache* cache)
+{
+    vector<BatchResult> results(jobs.size());
+    ProgramCache local;
+    if (cache == nullptr)
+        cache = &local;
+
+    if (workers == 0)
+        workers = max(1u, thread::hardware_concurrency());
+    workers = (unsigned)min<size_t>(workers, jobs.size());
+
+    atomic<size_t> next{0};
+    auto worker = [&]
+    {
+        for (size_t i = next++; i < jobs.size(); i = next++)
+        {
+            BatchResult& result = results[i];
+            shared_ptr<const CompiledProgram> prog = cache->Get(jobs[i].source);
+            if (!prog->ok)
+            {
+                result.errors = prog->errors;
+                result.output = prog->diagnostics;
+                continue;
+            }
+
+            Interp ctx;
+            InputSource input(jobs[i].input);
+            StringSink output;
+            ctx.Input = &input;
+            ctx.Sink = &output;
+            InterpScope scope(ctx);
+            result.ok = RunChunk(prog->chunk, prog->tier.Enter(prog->chunk));
+            result.errors = ctx.error_count;
+            result.output = output.Text();
+        }
+    };
+
+    vector<thread> pool;
+    for (unsigned w = 1; w < workers; w++)
+        pool.emplace_back(worker);
+    worker();
+    for (thread& t : pool)
+        t.join();
+    return results;
+}
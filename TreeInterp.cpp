@@ -0,0 +1,479 @@
+/* Tree-walking evaluator for parsed SADAL programs */
+#include <iostream>
+#include <string>
+#include "parserInterp.h"
+#include "treeInterp.h"
+#include "interp.h"
+
+static const Value* Operand(ExprNode* expr, Value& tmp);
+
+// Check that a value type matches the declared type of the variable receiving it
+bool TypeMatch(Token varType, ValType exprType)
+{
+    return (varType == INT && exprType == VINT) ||
+        (varType == FLOAT && exprType == VREAL) ||
+        (varType == BOOL && exprType == VBOOL) ||
+        (varType == STRING && exprType == VSTRING) ||
+        (varType == CHAR && exprType == VCHAR);
+}
+
+// Execute the declarations and then the statements of a parsed procedure
+bool RunProg(ProgNode* prog)
+{
+    StringPoolScope strings(Ctx->Strings);
+    Ctx->TempsResults.assign(prog->NumSlots(), Value());
+    Ctx->SlotNames = &prog->varNames;
+
+    bool status = ExecList(prog->decls) && ExecList(prog->body);
+
+    // String values live in the run's pool, so none may outlive the run
+    Ctx->TempsResults.assign(prog->NumSlots(), Value());
+    return status;
+}
+
+// Execute statements in order, stopping at the first run-time error
+bool ExecList(const vector<StmtNode*>& stmts)
+{
+    for (StmtNode* stmt : stmts)
+    {
+        if (!Exec(stmt))
+            return false;
+    }
+    return true;
+}
+
+// Evaluate optional initializer and assign it to every declared identifier
+static bool ExecDecl(DeclNode* decl)
+{
+    if (decl->init == nullptr)
+        return true;
+
+    Value val;
+    if (!Eval(decl->init, val))
+        return false;
+
+    if (!TypeMatch(decl->type, val.GetType()))
+    {
+        ParseError(decl->line, "Run-Time Error - Illegal Assignment Operation");
+        return false;
+    }
+
+    for (int slot : decl->slots)
+    {
+        Ctx->TempsResults[slot] = val;
+    }
+    return true;
+}
+
+// Evaluate RHS expression, check type matching, update variable value
+static bool ExecAssign(AssignNode* assign)
+{
+    Value val;
+    if (!Eval(assign->expr, val))
+        return false;
+
+    if (!TypeMatch(assign->type, val.GetType()))
+    {
+        ParseError(assign->line, "Run-Time Error-Illegal Assignment Operation");
+        return false;
+    }
+
+    Ctx->TempsResults[assign->slot] = val;
+    return true;
+}
+
+// Print evaluated expression, with a newline for PUTLN
+static bool ExecPrint(PrintNode* print)
+{
+    Value tmp;
+    const Value* val = Operand(print->expr, tmp);
+    if (val == nullptr)
+        return false;
+
+    *Ctx->Sink << *val;
+    if (print->newline)
+        *Ctx->Sink << '\n';
+
+    return true;
+}
+
+// Read user input and convert it to the declared type. A variable of unknown type reads input but receives nothing
+bool ReadValue(Token type, int line, Value& retVal)
+{
+    string_view input;
+    Ctx->Input->Next(input);
+
+    if (type == INT)
+    {
+        int value;
+        if (!ParseNumber(input, value))
+        {
+            ParseError(line, "Invalid input for variable type.");
+            return false;
+        }
+        retVal = Value(value);
+    }
+    else if (type == FLOAT)
+    {
+        double value;
+        if (!ParseNumber(input, value))
+        {
+            ParseError(line, "Invalid input for variable type.");
+            return false;
+        }
+        retVal = Value(value);
+    }
+    else if (type == BOOL)
+    {
+        if (input == "true")
+            retVal = Value(true);
+        else if (input == "false")
+            retVal = Value(false);
+        else
+        {
+            ParseError(line, "Invalid boolean input.");
+            return false;
+        }
+    }
+    else if (type == STRING)
+    {
+        retVal = Value(string(input));
+    }
+    else if (type == CHAR)
+    {
+        if (input.length() != 1)
+        {
+            ParseError(line, "Invalid character input.");
+            return false;
+        }
+        retVal = Value(input[0]);
+    }
+
+    return true;
+}
+
+// Read user input into the variable of a GET statement
+static bool ExecGet(GetNode* get)
+{
+    Value val;
+    if (!ReadValue(get->type, get->line, val))
+        return false;
+
+    if (!val.IsErr())
+        Ctx->TempsResults[get->slot] = val;
+    return true;
+}
+
+// Evaluate IF/ELSIF conditions in order and run the statements of the first true arm, or the ELSE part
+static bool ExecIf(IfNode* ifNode)
+{
+    for (size_t i = 0; i < ifNode->arms.size(); i++)
+    {
+        IfArm& arm = ifNode->arms[i];
+        Value condVal;
+        if (!Eval(arm.cond, condVal))
+            return false;
+
+        if (condVal.GetType() != VBOOL)
+        {
+            if (i == 0)
+                ParseError(arm.cond->line, "Missing if statement condition");
+            else
+                ParseError(arm.cond->line, "Invalid expression type for an Elsif condition");
+            ParseError(arm.cond->line, "Invalid If statement.");
+            return false;
+        }
+
+        if (Ctx->Prof != nullptr)
+        {
+            Ctx->Prof->Outcome(ifNode, i, condVal.GetBool());
+            if (condVal.GetBool())
+                Ctx->Prof->Outcome(ifNode, ifNode->arms.size(), false);
+        }
+        if (condVal.GetBool())
+            return ExecList(arm.body);
+    }
+
+    if (Ctx->Prof != nullptr)
+        Ctx->Prof->Outcome(ifNode, ifNode->arms.size(), true);
+    return ExecList(ifNode->elseBody);
+}
+
+// Run the body while the condition holds, checking the condition is boolean on every test
+static bool ExecWhile(WhileNode* loop)
+{
+    while (true)
+    {
+        Value condVal;
+        if (!Eval(loop->cond, condVal))
+            return false;
+
+        if (condVal.GetType() != VBOOL)
+        {
+            ParseError(loop->cond->line, "Invalid expression type for a While condition");
+            ParseError(loop->cond->line, "Invalid While statement.");
+            return false;
+        }
+
+        if (Ctx->Prof != nullptr)
+            Ctx->Prof->Outcome(loop, 0, condVal.GetBool());
+        if (!condVal.GetBool())
+            return true;
+        if (!ExecList(loop->body))
+            return false;
+    }
+}
+
+// Evaluate both bounds once, then run the body with the loop variable at each value from low to high
+static bool ExecFor(ForNode* loop)
+{
+    Value low, high;
+    if (!Eval(loop->low, low) || !Eval(loop->high, high))
+        return false;
+
+    if (!low.IsInt() || !high.IsInt())
+    {
+        ParseError(loop->line, "Run-Time Error-Non-integer bounds in For loop range");
+        return false;
+    }
+
+    int last = high.GetInt();
+    for (int i = low.GetInt(); i <= last; i++)
+    {
+        Ctx->TempsResults[loop->slot] = Value(i);
+        if (!ExecList(loop->body))
+            return false;
+        if (i == last)
+            break;
+    }
+    return true;
+}
+
+// Execute one statement according to its kind
+static bool Dispatch(StmtNode* stmt)
+{
+    switch (stmt->kind)
+    {
+        case DECL_NODE: return ExecDecl(static_cast<DeclNode*>(stmt));
+        case ASSIGN_NODE: return ExecAssign(static_cast<AssignNode*>(stmt));
+        case PRINT_NODE: return ExecPrint(static_cast<PrintNode*>(stmt));
+        case GET_NODE: return ExecGet(static_cast<GetNode*>(stmt));
+        case IF_NODE: return ExecIf(static_cast<IfNode*>(stmt));
+        case WHILE_NODE: return ExecWhile(static_cast<WhileNode*>(stmt));
+        case FOR_NODE: return ExecFor(static_cast<ForNode*>(stmt));
+        default: return false;
+    }
+}
+
+// Execute one statement, timing it when a profiler is installed
+bool Exec(StmtNode* stmt)
+{
+    if (Ctx->Prof == nullptr)
+        return Dispatch(stmt);
+
+    Profiler::Timer timer(*Ctx->Prof, stmt);
+    return Dispatch(stmt);
+}
+
+// Index a string value: s(i) gives a character
+bool IndexString(const Value& str, const Value& index, int line, Value& retVal)
+{
+    if (!index.IsInt())
+    {
+        ParseError(line, "Run-Time Error-Non-integer index for string");
+        return false;
+    }
+
+    int idx = index.GetInt();
+    string_view s = str.GetString();
+
+    if (idx < 0 || idx >= (int)s.length())
+    {
+        ParseError(line, "Run-Time Error-Index out of bounds");
+        return false;
+    }
+    retVal = Value(s[idx]);
+    return true;
+}
+
+// Slice a string value: s(i..j) gives the characters i through j
+bool SliceString(const Value& str, const Value& index1, const Value& index2, int line, Value& retVal)
+{
+    if (!index1.IsInt() || !index2.IsInt())
+    {
+        ParseError(line, "Run-Time Error-Non-integer index for string");
+        return false;
+    }
+
+    int i1 = index1.GetInt();
+    int i2 = index2.GetInt();
+    string_view s = str.GetString();
+
+    if (i1 < 0 || i1 >= (int)s.length() || i2 < 0 || i2 >= (int)s.length())
+    {
+        ParseError(line, "Run-Time Error-Index out of bounds");
+        return false;
+    }
+
+    if (i1 > i2)
+    {
+        ParseError(line, "Run-Time Error-Invalid range bounds");
+        return false;
+    }
+    retVal = str.Slice(i1, i2 - i1 + 1);
+    return true;
+}
+
+// Apply a leading minus sign, which is only legal on numbers
+bool Negate(const Value& val, int line, Value& retVal)
+{
+    if (val.IsInt())
+        retVal = Value(IntNeg(val.GetInt()));
+    else if (val.IsReal())
+        retVal = Value(-val.GetReal());
+    else
+    {
+        ParseError(line, "Run-Time Error-Illegal sign operation");
+        return false;
+    }
+    return true;
+}
+
+// Look up the slot of a variable reference, reporting an error if it was never assigned
+static const Value* Variable(NameNode* name)
+{
+    const Value& varValue = Ctx->TempsResults[name->slot];
+    if (varValue.IsErr())
+    {
+        ParseError(name->line, "Run-Time Error-Using uninitialized variable" + (*Ctx->SlotNames)[name->slot]);
+        ParseError(name->line, "Invalid reference to a variable.");
+        return nullptr;
+    }
+    return &varValue;
+}
+
+// Retrieve variable value from runtime table. Handle string indexing and slicing operations
+static bool EvalName(NameNode* name, Value& retVal)
+{
+    int line = name->line;
+    const Value* var = Variable(name);
+    if (var == nullptr)
+        return false;
+
+    const Value& varValue = *var;
+    if (name->index1 == nullptr)
+    {
+        retVal = varValue;
+        return true;
+    }
+
+    if (!varValue.IsString())
+    {
+        ParseError(line, "Run-Time Error-Indexing a non-string variable");
+        return false;
+    }
+
+    Value index1, index2;
+    if (!Eval(name->index1, index1))
+        return false;
+
+    if (name->index2 == nullptr)
+        return IndexString(varValue, index1, line, retVal);
+
+    if (!Eval(name->index2, index2))
+        return false;
+
+    return SliceString(varValue, index1, index2, line, retVal);
+}
+
+// Evaluate an operand. Plain variables and constants are read in place rather than copied into tmp
+static const Value* Operand(ExprNode* expr, Value& tmp)
+{
+    if (expr->kind == NAME_NODE && static_cast<NameNode*>(expr)->index1 == nullptr)
+        return Variable(static_cast<NameNode*>(expr));
+    if (expr->kind == CONST_NODE)
+        return &static_cast<ConstNode*>(expr)->val;
+
+    if (!Eval(expr, tmp))
+        return nullptr;
+    return &tmp;
+}
+
+// Apply NOT or a leading minus sign
+static bool EvalUnary(UnaryNode* unary, Value& retVal)
+{
+    Value tmp;
+    const Value* operand = Operand(unary->operand, tmp);
+    if (operand == nullptr)
+        return false;
+
+    const Value& val = *operand;
+
+    if (unary->op == MINUS)
+        return Negate(val, unary->line, retVal);
+
+    retVal = !val;
+    return true;
+}
+
+// Report the error an operation raised, if any, at the line of the node or instruction that performed it
+bool Raised(const Value& val, int line)
+{
+    const char* error = val.Raised();
+    if (error == nullptr)
+        return false;
+    ParseError(line, error);
+    return true;
+}
+
+// Apply a logical, relational or arithmetic operator. A run-time error comes back as a raised error value
+Value ApplyBinary(Token op, const Value& val1, const Value& val2)
+{
+    switch (op)
+    {
+        case AND: return val1 && val2;
+        case OR: return val1 || val2;
+        case EQ: return val1 == val2;
+        case NEQ: return val1 != val2;
+        case LTHAN: return val1 < val2;
+        case LTE: return val1 <= val2;
+        case GTHAN: return val1 > val2;
+        case GTE: return val1 >= val2;
+        case PLUS: return val1 + val2;
+        case MINUS: return val1 - val2;
+        case CONCAT: return val1.Concat(val2);
+        case MULT: return val1 * val2;
+        case DIV: return val1 / val2;
+        case MOD: return val1 % val2;
+        case EXP: return val1.Exp(val2);
+        default: return Value();
+    }
+}
+
+// Evaluate both operands, then apply a logical, relational or arithmetic operator
+static bool EvalBinary(BinaryNode* binary, Value& retVal)
+{
+    Value tmp1, tmp2;
+    const Value* op1 = Operand(binary->left, tmp1);
+    if (op1 == nullptr)
+        return false;
+    const Value* op2 = Operand(binary->right, tmp2);
+    if (op2 == nullptr)
+        return false;
+
+    retVal = ApplyBinary(binary->op, *op1, *op2);
+    return !retVal.IsErr() || !Raised(retVal, binary->line);
+}
+
+// Evaluate an expression tree into retVal
+bool Eval(ExprNode* expr, Value& retVal)
+{
+    switch (expr->kind)
+    {
+        case CONST_NODE: retVal = static_cast<ConstNode*>(expr)->val; return true;
+        case NAME_NODE: return EvalName(static_cast<NameNode*>(expr), retVal);
+        case UNARY_NODE: return EvalUnary(static_cast<UnaryNode*>(expr), retVal);
+        case BINARY_NODE: return EvalBinary(static_cast<BinaryNode*>(expr), retVal);
+        default: return false;
+    }
+}
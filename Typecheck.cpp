@@ -0,0 +1,156 @@
+/* Static typing: give each expression the type its value is certain to have when evaluation succeeds */
+#include "typecheck.h"
+
+static Token ConstType(const Value& val)
+{
+    switch (val.GetType())
+    {
+        case VINT: return INT;
+        case VREAL: return FLOAT;
+        case VBOOL: return BOOL;
+        case VSTRING: return STRING;
+        case VCHAR: return CHAR;
+        default: return ERR;
+    }
+}
+
+static bool IsNumber(Token type)
+{
+    return type == INT || type == FLOAT;
+}
+
+// A constant divisor other than zero; any other divisor may make the quotient an error value
+static bool NonZeroConst(ExprNode* expr)
+{
+    if (expr->kind != CONST_NODE)
+        return false;
+    const Value& val = static_cast<ConstNode*>(expr)->val;
+    return (val.IsInt() && val.GetInt() != 0) || (val.IsReal() && val.GetReal() != 0.0);
+}
+
+// Type of a binary operator application, following the Value operators in val.h
+static Token BinaryType(BinaryNode* binary)
+{
+    Token left = binary->left->type;
+    Token right = binary->right->type;
+
+    switch (binary->op)
+    {
+        case PLUS: case MINUS: case MULT:
+            if (!IsNumber(left) || !IsNumber(right))
+                return ERR;
+            return (left == INT && right == INT) ? INT : FLOAT;
+        case DIV:
+            if (!IsNumber(left) || !IsNumber(right) || !NonZeroConst(binary->right))
+                return ERR;
+            return (left == INT && right == INT) ? INT : FLOAT;
+        case MOD:
+            return (left == INT && right == INT && NonZeroConst(binary->right)) ? INT : ERR;
+        case EXP:
+            return (IsNumber(left) && IsNumber(right)) ? FLOAT : ERR;
+        case CONCAT:
+            return (left == STRING && right == STRING) ? STRING : ERR;
+        case EQ: case NEQ:
+            return BOOL;
+        case LTHAN: case LTE: case GTHAN: case GTE:
+            return (IsNumber(left) && IsNumber(right)) ? BOOL : ERR;
+        case AND: case OR:
+            return (left == BOOL && right == BOOL) ? BOOL : ERR;
+        default:
+            return ERR;
+    }
+}
+
+static void TypeExpr(ProgNode* prog, ExprNode* expr)
+{
+    if (expr == nullptr)
+        return;
+
+    switch (expr->kind)
+    {
+        case CONST_NODE:
+            expr->type = ConstType(static_cast<ConstNode*>(expr)->val);
+            break;
+        case NAME_NODE:
+        {
+            // Every assignment checks the declared type, so a variable read without error holds that type
+            NameNode* name = static_cast<NameNode*>(expr);
+            TypeExpr(prog, name->index1);
+            TypeExpr(prog, name->index2);
+            if (name->index1 == nullptr)
+                expr->type = prog->varTypes[name->slot];
+            else
+                expr->type = (name->index2 == nullptr) ? CHAR : STRING;
+            break;
+        }
+        case UNARY_NODE:
+        {
+            UnaryNode* unary = static_cast<UnaryNode*>(expr);
+            TypeExpr(prog, unary->operand);
+            Token operand = unary->operand->type;
+            if (unary->op == NOT)
+                expr->type = (operand == BOOL) ? BOOL : ERR;
+            else
+                expr->type = IsNumber(operand) ? operand : ERR;
+            break;
+        }
+        case BINARY_NODE:
+        {
+            BinaryNode* binary = static_cast<BinaryNode*>(expr);
+            TypeExpr(prog, binary->left);
+            TypeExpr(prog, binary->right);
+            expr->type = BinaryType(binary);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+static void TypeList(ProgNode* prog, const vector<StmtNode*>& stmts)
+{
+    for (StmtNode* stmt : stmts)
+    {
+        switch (stmt->kind)
+        {
+            case DECL_NODE: TypeExpr(prog, static_cast<DeclNode*>(stmt)->init); break;
+            case ASSIGN_NODE: TypeExpr(prog, static_cast<AssignNode*>(stmt)->expr); break;
+            case PRINT_NODE: TypeExpr(prog, static_cast<PrintNode*>(stmt)->expr); break;
+            case IF_NODE:
+            {
+                IfNode* ifNode = static_cast<IfNode*>(stmt);
+                for (IfArm& arm : ifNode->arms)
+                {
+                    TypeExpr(prog, arm.cond);
+                    TypeList(prog, arm.body);
+                }
+                TypeList(prog, ifNode->elseBody);
+                break;
+            }
+            case WHILE_NODE:
+            {
+                WhileNode* loop = static_cast<WhileNode*>(stmt);
+                TypeExpr(prog, loop->cond);
+                TypeList(prog, loop->body);
+                break;
+            }
+            case FOR_NODE:
+            {
+                ForNode* loop = static_cast<ForNode*>(stmt);
+                TypeExpr(prog, loop->low);
+                TypeExpr(prog, loop->high);
+                TypeList(prog, loop->body);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+}
+
+// Annotate every expression of a parsed procedure with its static type
+void TypeProg(ProgNode* prog)
+{
+    TypeList(prog, prog->decls);
+    TypeList(prog, prog->body);
+}
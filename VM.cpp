@@ -0,0 +1,285 @@
+/* Register VM executing compiled SADAL bytecode */
+#include <iostream>
+#include <iomanip>
+#include "parserInterp.h"
+#include "treeInterp.h"
+#include "vm.h"
+#include "jit.h"
+#include "interp.h"
+
+// Run a compiled procedure from the start with fresh variable slots, in machine code where jit has it
+bool RunChunk(const Chunk& chunk, const JitCode* jit)
+{
+    StringPoolScope strings(Ctx->Strings);
+    vector<Value> R(chunk.nregs);
+    for (size_t k = 0; k < chunk.consts.size(); k++)
+        R[chunk.ConstBase() + k] = chunk.consts[k];
+
+    const JitCode::Entry* native = jit != nullptr ? jit->Entries() : nullptr;
+    const Instr* code = chunk.code.data();
+    for (size_t pc = 0;; pc++)
+    {
+        // Machine code runs up to an instruction it leaves to the VM, which is executed here
+        if (native != nullptr && native[pc] != nullptr)
+            pc = native[pc](R.data());
+
+        const Instr& I = code[pc];
+        int line = chunk.lines[pc];
+        switch (I.op)
+        {
+            case OP_MOVE: R[I.a] = R[I.b]; break;
+            case OP_CHKINIT:
+                if (R[I.a].IsErr())
+                {
+                    ParseError(line, "Run-Time Error-Using uninitialized variable" + chunk.varNames[I.a]);
+                    ParseError(line, "Invalid reference to a variable.");
+                    return false;
+                }
+                break;
+            case OP_CHKSTR:
+                if (!R[I.a].IsString())
+                {
+                    ParseError(line, "Run-Time Error-Indexing a non-string variable");
+                    return false;
+                }
+                break;
+            case OP_CHKTYPE:
+                if (!TypeMatch((Token)I.b, R[I.a].GetType()))
+                {
+                    ParseError(line, I.c ? "Run-Time Error - Illegal Assignment Operation" : "Run-Time Error-Illegal Assignment Operation");
+                    return false;
+                }
+                break;
+            case OP_ADD: R[I.a] = R[I.b] + R[I.c]; break;
+            case OP_SUB: R[I.a] = R[I.b] - R[I.c]; break;
+            case OP_MUL: R[I.a] = R[I.b] * R[I.c]; break;
+            case OP_DIV: R[I.a] = R[I.b] / R[I.c]; break;
+            case OP_MOD: R[I.a] = R[I.b] % R[I.c]; break;
+            case OP_EXP: R[I.a] = R[I.b].Exp(R[I.c]); break;
+            case OP_CONCAT: R[I.a] = R[I.b].Concat(R[I.c]); break;
+            case OP_EQ: R[I.a] = (R[I.b] == R[I.c]); break;
+            case OP_NEQ: R[I.a] = (R[I.b] != R[I.c]); break;
+            case OP_LT: R[I.a] = (R[I.b] < R[I.c]); break;
+            case OP_LTE:
+                R[I.a] = (R[I.b] <= R[I.c]);
+                if (Raised(R[I.a], line))
+                    return false;
+                break;
+            case OP_GT:
+                R[I.a] = (R[I.b] > R[I.c]);
+                if (Raised(R[I.a], line))
+                    return false;
+                break;
+            case OP_GTE:
+                R[I.a] = (R[I.b] >= R[I.c]);
+                if (Raised(R[I.a], line))
+                    return false;
+                break;
+            case OP_AND: R[I.a] = R[I.b] && R[I.c]; break;
+            case OP_OR: R[I.a] = R[I.b] || R[I.c]; break;
+            case OP_NOT: R[I.a] = !R[I.b]; break;
+            case OP_NEG:
+            {
+                Value val;
+                if (!Negate(R[I.b], line, val))
+                    return false;
+                R[I.a] = val;
+                break;
+            }
+            case OP_IADD: R[I.a].StoreInt(IntAdd(R[I.b].RawInt(), R[I.c].RawInt())); break;
+            case OP_ISUB: R[I.a].StoreInt(IntSub(R[I.b].RawInt(), R[I.c].RawInt())); break;
+            case OP_IMUL: R[I.a].StoreInt(IntMul(R[I.b].RawInt(), R[I.c].RawInt())); break;
+            case OP_IDIV: R[I.a].StoreInt(IntDiv(R[I.b].RawInt(), R[I.c].RawInt())); break;
+            case OP_IMOD: R[I.a].StoreInt(IntMod(R[I.b].RawInt(), R[I.c].RawInt())); break;
+            case OP_IEQ: R[I.a].StoreBool(R[I.b].RawInt() == R[I.c].RawInt()); break;
+            case OP_INEQ: R[I.a].StoreBool(R[I.b].RawInt() != R[I.c].RawInt()); break;
+            case OP_ILT: R[I.a].StoreBool(R[I.b].RawInt() < R[I.c].RawInt()); break;
+            case OP_ILTE: R[I.a].StoreBool(R[I.b].RawInt() <= R[I.c].RawInt()); break;
+            case OP_IGT: R[I.a].StoreBool(R[I.b].RawInt() > R[I.c].RawInt()); break;
+            case OP_IGTE: R[I.a].StoreBool(R[I.b].RawInt() >= R[I.c].RawInt()); break;
+            case OP_INEG: R[I.a].StoreInt(IntNeg(R[I.b].RawInt())); break;
+            case OP_RADD: R[I.a].StoreReal(R[I.b].RawReal() + R[I.c].RawReal()); break;
+            case OP_RSUB: R[I.a].StoreReal(R[I.b].RawReal() - R[I.c].RawReal()); break;
+            case OP_RMUL: R[I.a].StoreReal(R[I.b].RawReal() * R[I.c].RawReal()); break;
+            case OP_RDIV: R[I.a].StoreReal(R[I.b].RawReal() / R[I.c].RawReal()); break;
+            // Real comparisons spell out the Value operators, which define > as not <= and >= as not <
+            case OP_REQ: R[I.a].StoreBool(R[I.b].RawReal() == R[I.c].RawReal()); break;
+            case OP_RNEQ: R[I.a].StoreBool(!(R[I.b].RawReal() == R[I.c].RawReal())); break;
+            case OP_RLT: R[I.a].StoreBool(R[I.b].RawReal() < R[I.c].RawReal()); break;
+            case OP_RLTE: R[I.a].StoreBool(R[I.b].RawReal() <= R[I.c].RawReal()); break;
+            case OP_RGT: R[I.a].StoreBool(!(R[I.b].RawReal() <= R[I.c].RawReal())); break;
+            case OP_RGTE: R[I.a].StoreBool(!(R[I.b].RawReal() < R[I.c].RawReal())); break;
+            case OP_RNEG: R[I.a].StoreReal(-R[I.b].RawReal()); break;
+            case OP_BAND: R[I.a].StoreBool(R[I.b].RawBool() && R[I.c].RawBool()); break;
+            case OP_BOR: R[I.a].StoreBool(R[I.b].RawBool() || R[I.c].RawBool()); break;
+            case OP_BNOT: R[I.a].StoreBool(!R[I.b].RawBool()); break;
+            case OP_ITOR: R[I.a].StoreReal(R[I.b].RawInt()); break;
+            case OP_INDEX:
+            {
+                Value val;
+                if (!IndexString(R[I.b], R[I.c], line, val))
+                    return false;
+                R[I.a] = val;
+                break;
+            }
+            case OP_SLICE:
+            {
+                Value val;
+                if (!SliceString(R[I.b], R[I.c], R[I.c + 1], line, val))
+                    return false;
+                R[I.a] = val;
+                break;
+            }
+            case OP_PRINT:
+                *Ctx->Sink << R[I.a];
+                if (I.b)
+                    *Ctx->Sink << '\n';
+                break;
+            case OP_GET:
+            {
+                Value val;
+                if (!ReadValue((Token)I.b, line, val))
+                    return false;
+                if (!val.IsErr())
+                    R[I.a] = val;
+                break;
+            }
+            case OP_JMP: pc = I.a - 1; break;
+            case OP_JMPF:
+                if (!R[I.a].IsBool())
+                {
+                    if (I.c == 2)
+                    {
+                        ParseError(line, "Invalid expression type for a While condition");
+                        ParseError(line, "Invalid While statement.");
+                    }
+                    else
+                    {
+                        ParseError(line, I.c ? "Invalid expression type for an Elsif condition" : "Missing if statement condition");
+                        ParseError(line, "Invalid If statement.");
+                    }
+                    return false;
+                }
+                if (!R[I.a].GetBool())
+                    pc = I.b - 1;
+                break;
+            case OP_FORPREP:
+                if (!R[I.a].IsInt() || !R[I.b].IsInt())
+                {
+                    ParseError(line, "Run-Time Error-Non-integer bounds in For loop range");
+                    return false;
+                }
+                if (R[I.a].RawInt() > R[I.b].RawInt())
+                    pc = I.c - 1;
+                break;
+            case OP_FORLOOP:
+                if (R[I.a].RawInt() < R[I.b].RawInt())
+                {
+                    R[I.a].StoreInt(R[I.a].RawInt() + 1);
+                    pc = I.c - 1;
+                }
+                break;
+            case OP_HALT: return true;
+        }
+    }
+}
+
+static const char* OpNames[] =
+{
+    "MOVE", "CHKINIT", "CHKSTR", "CHKTYPE",
+    "ADD", "SUB", "MUL", "DIV", "MOD", "EXP", "CONCAT",
+    "EQ", "NEQ", "LT", "LTE", "GT", "GTE",
+    "AND", "OR", "NOT", "NEG",
+    "IADD", "ISUB", "IMUL", "IDIV", "IMOD",
+    "IEQ", "INEQ", "ILT", "ILTE", "IGT", "IGTE", "INEG",
+    "RADD", "RSUB", "RMUL", "RDIV",
+    "REQ", "RNEQ", "RLT", "RLTE", "RGT", "RGTE", "RNEG",
+    "BAND", "BOR", "BNOT", "ITOR",
+    "INDEX", "SLICE",
+    "PRINT", "GET", "JMP", "JMPF", "FORPREP", "FORLOOP", "HALT"
+};
+
+// Readable register name: variables by name, constants by value, temporaries by number
+static string RegName(const Chunk& chunk, int reg)
+{
+    ostringstream name;
+    if (reg < chunk.ConstBase())
+        name << chunk.varNames[reg];
+    else if (reg < chunk.TempBase())
+    {
+        const Value& val = chunk.consts[reg - chunk.ConstBase()];
+        name << "k" << reg - chunk.ConstBase() << "(";
+        if (val.IsString())
+            name << '"' << val << '"';
+        else if (val.IsChar())
+            name << '\'' << val << '\'';
+        else
+            name << val;
+        name << ")";
+    }
+    else
+        name << "t" << reg - chunk.TempBase();
+    return name.str();
+}
+
+static string TypeName(Token type)
+{
+    switch (type)
+    {
+        case INT: return "INTEGER";
+        case FLOAT: return "FLOAT";
+        case BOOL: return "BOOLEAN";
+        case STRING: return "STRING";
+        case CHAR: return "CHARACTER";
+        default: return "-";
+    }
+}
+
+// Print a readable listing of a compiled procedure for --emit-bytecode
+void DumpChunk(const Chunk& chunk, ostream& out)
+{
+    out << "; procedure " << chunk.name << ": " << chunk.varNames.size() << " slots, "
+        << chunk.consts.size() << " constants, " << chunk.nregs - chunk.TempBase() << " temporaries" << endl;
+    for (size_t slot = 0; slot < chunk.varNames.size(); slot++)
+        out << ";   slot " << slot << ": " << chunk.varNames[slot] << " " << TypeName(chunk.varTypes[slot]) << endl;
+
+    for (size_t pc = 0; pc < chunk.code.size(); pc++)
+    {
+        const Instr& I = chunk.code[pc];
+        out << setw(5) << pc << "  [" << setw(4) << chunk.lines[pc] << "]  " << left << setw(8) << OpNames[I.op] << right;
+        switch (I.op)
+        {
+            case OP_CHKINIT: case OP_CHKSTR:
+                out << RegName(chunk, I.a);
+                break;
+            case OP_CHKTYPE: case OP_GET:
+                out << RegName(chunk, I.a) << ", " << TypeName((Token)I.b);
+                break;
+            case OP_MOVE: case OP_NOT: case OP_NEG: case OP_INEG: case OP_RNEG: case OP_BNOT: case OP_ITOR:
+                out << RegName(chunk, I.a) << ", " << RegName(chunk, I.b);
+                break;
+            case OP_SLICE:
+                out << RegName(chunk, I.a) << ", " << RegName(chunk, I.b) << ", " << RegName(chunk, I.c)
+                    << " .. " << RegName(chunk, I.c + 1);
+                break;
+            case OP_PRINT:
+                out << RegName(chunk, I.a) << (I.b ? ", newline" : "");
+                break;
+            case OP_JMP:
+                out << "-> " << I.a;
+                break;
+            case OP_JMPF:
+                out << RegName(chunk, I.a) << ", -> " << I.b;
+                break;
+            case OP_FORPREP: case OP_FORLOOP:
+                out << RegName(chunk, I.a) << ", " << RegName(chunk, I.b) << ", -> " << I.c;
+                break;
+            case OP_HALT:
+                break;
+            default:
+                out << RegName(chunk, I.a) << ", " << RegName(chunk, I.b) << ", " << RegName(chunk, I.c);
+                break;
+        }
+        out << endl;
+    }
+}
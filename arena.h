@@ -0,0 +1,133 @@
+// Header file for the bump allocator parse trees and run-time string storage are carved from
+#ifndef ARENA_H_
+#define ARENA_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include <new>
+#include <utility>
+#include <type_traits>
+
+using namespace std;
+
+// Allocation counts for the calling thread, so a run's steady state can be checked for heap traffic
+struct AllocStats
+{
+    size_t arenaBlocks = 0;     // blocks arenas took from the heap
+    size_t arenaBytes = 0;      // bytes in those blocks
+    size_t arenaObjects = 0;    // objects and names carved from arenas
+    size_t heapStrings = 0;     // string buffers and views allocated on the heap, outside any run
+    size_t pooledStrings = 0;   // string buffers and views taken from a run's pool
+};
+
+extern thread_local AllocStats Allocs;
+
+// Memory handed out by bumping a pointer through large blocks. Nothing is freed on its own: Reset rewinds
+// to the first block, keeping the blocks for reuse, and destruction frees them all at once. Objects
+// with destructors get them run, newest first, at Reset or destruction.
+// Small blocks of memory can also be recycled through per-size free lists with Take and Give
+class Arena
+{
+    struct Block
+    {
+        char* base;
+        size_t size;
+    };
+
+    struct Finalizer
+    {
+        void (*destroy)(void*);
+        void* obj;
+        Finalizer* next;
+    };
+
+    // Free lists for Take and Give, in power-of-two size classes from MinClass bytes up
+    static const size_t MinClass = 16;
+    static const int NumClasses = 9;
+    struct FreeChunk
+    {
+        FreeChunk* next;
+    };
+
+    vector<Block> blocks;
+    size_t current = 0;
+    char* cur = nullptr;
+    char* end = nullptr;
+    size_t firstSize;
+    Finalizer* finalizers = nullptr;
+    FreeChunk* freeLists[NumClasses] = {};
+
+    char* Grow(size_t size, size_t align);
+    void RunFinalizers();
+
+    static int SizeClass(size_t size)
+    {
+        int cls = 0;
+        for (size_t cap = MinClass; cap < size; cap *= 2)
+            cls++;
+        return cls;
+    }
+
+public:
+    explicit Arena(size_t firstBlock = 4096) : firstSize(firstBlock) {}
+    ~Arena();
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* Allocate(size_t size, size_t align = alignof(max_align_t))
+    {
+        char* p = reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(cur) + align - 1) & ~(uintptr_t)(align - 1));
+        // Rounding up to align can carry p past the end of the block, where end - p would be negative
+        if (cur == nullptr || p > end || size > (size_t)(end - p))
+            p = Grow(size, align);
+        cur = p + size;
+        Allocs.arenaObjects++;
+        return p;
+    }
+
+    // Construct an object in the arena. It is destroyed with the arena, never deleted
+    template <class T, class... Args>
+    T* New(Args&&... args)
+    {
+        T* obj = new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        if constexpr (!is_trivially_destructible_v<T>)
+        {
+            Finalizer* fin = static_cast<Finalizer*>(Allocate(sizeof(Finalizer), alignof(Finalizer)));
+            *fin = Finalizer{ [](void* p) { static_cast<T*>(p)->~T(); }, obj, finalizers };
+            finalizers = fin;
+        }
+        return obj;
+    }
+
+    // A copy of text that lives as long as the arena
+    string_view Copy(string_view text);
+
+    // Memory for size bytes, reusing a chunk given back earlier if one of its size class is free.
+    // Sizes above MaxTake bytes are not pooled
+    static const size_t MaxTake = MinClass << (NumClasses - 1);
+    void* Take(size_t size)
+    {
+        int cls = SizeClass(size);
+        if (FreeChunk* chunk = freeLists[cls])
+        {
+            freeLists[cls] = chunk->next;
+            return chunk;
+        }
+        return Allocate(MinClass << cls);
+    }
+
+    void Give(void* p, size_t size)
+    {
+        int cls = SizeClass(size);
+        FreeChunk* chunk = static_cast<FreeChunk*>(p);
+        chunk->next = freeLists[cls];
+        freeLists[cls] = chunk;
+    }
+
+    void Reset();
+    size_t Capacity() const;
+};
+
+#endif
@@ -0,0 +1,180 @@
+// Header file defining the abstract syntax tree built by the parser
+#ifndef AST_H_
+#define AST_H_
+
+#include <string>
+#include <vector>
+#include "lex.h"
+#include "val.h"
+#include "arena.h"
+
+using namespace std;
+
+// Node kinds: expressions produced by Expr..Primary/Name, statements produced by Stmt and DeclStmt
+enum NodeKind
+{
+    CONST_NODE, NAME_NODE, UNARY_NODE, BINARY_NODE,
+    DECL_NODE, ASSIGN_NODE, PRINT_NODE, GET_NODE, IF_NODE, WHILE_NODE, FOR_NODE
+};
+
+// Common base: every node remembers the source line it was parsed on for run-time error reports
+struct Node
+{
+    NodeKind kind;
+    int line;
+
+    Node(NodeKind kind, int line) : kind(kind), line(line) {}
+    virtual ~Node() {}
+};
+
+// type is the static type TypeProg proves the value has (INT, FLOAT, BOOL, STRING, CHAR), or ERR when only
+// the run can tell, e.g. a quotient that may be a division by zero
+struct ExprNode : Node
+{
+    Token type = ERR;
+
+    ExprNode(NodeKind kind, int line) : Node(kind, line) {}
+};
+
+struct StmtNode : Node
+{
+    StmtNode(NodeKind kind, int line) : Node(kind, line) {}
+};
+
+// Literal constant from Primary, with any leading sign already applied
+struct ConstNode : ExprNode
+{
+    Value val;
+
+    ConstNode(const Value& val, int line) : ExprNode(CONST_NODE, line), val(val) {}
+};
+
+// Variable reference from Name: plain, indexed s(i) or sliced s(i..j). The slot is fixed at parse time
+struct NameNode : ExprNode
+{
+    int slot;
+    ExprNode* index1;
+    ExprNode* index2;
+
+    NameNode(int slot, int line) : ExprNode(NAME_NODE, line), slot(slot), index1(nullptr), index2(nullptr) {}
+};
+
+// NOT from Factor, or a MINUS sign from STerm applied to a name or parenthesized expression
+struct UnaryNode : ExprNode
+{
+    Token op;
+    ExprNode* operand;
+
+    UnaryNode(Token op, ExprNode* operand, int line) : ExprNode(UNARY_NODE, line), op(op), operand(operand) {}
+};
+
+// Logical, relational, additive, multiplicative and exponent operators
+struct BinaryNode : ExprNode
+{
+    Token op;
+    ExprNode* left;
+    ExprNode* right;
+
+    BinaryNode(Token op, ExprNode* left, ExprNode* right, int line)
+        : ExprNode(BINARY_NODE, line), op(op), left(left), right(right) {}
+};
+
+// Declaration of one or more identifiers of a type with an optional initializer
+struct DeclNode : StmtNode
+{
+    vector<int> slots;
+    Token type;
+    ExprNode* init;
+
+    DeclNode(Token type, int line) : StmtNode(DECL_NODE, line), type(type), init(nullptr) {}
+};
+
+struct AssignNode : StmtNode
+{
+    int slot;
+    Token type;
+    ExprNode* expr;
+
+    AssignNode(int slot, Token type, ExprNode* expr, int line)
+        : StmtNode(ASSIGN_NODE, line), slot(slot), type(type), expr(expr) {}
+};
+
+struct PrintNode : StmtNode
+{
+    bool newline;
+    ExprNode* expr;
+
+    PrintNode(bool newline, ExprNode* expr, int line) : StmtNode(PRINT_NODE, line), newline(newline), expr(expr) {}
+};
+
+struct GetNode : StmtNode
+{
+    int slot;
+    Token type;
+
+    GetNode(int slot, Token type, int line) : StmtNode(GET_NODE, line), slot(slot), type(type) {}
+};
+
+// One IF or ELSIF condition together with the statements it guards
+struct IfArm
+{
+    ExprNode* cond;
+    vector<StmtNode*> body;
+};
+
+struct IfNode : StmtNode
+{
+    vector<IfArm> arms;
+    vector<StmtNode*> elseBody;
+
+    IfNode(int line) : StmtNode(IF_NODE, line) {}
+};
+
+// WHILE cond LOOP body END LOOP
+struct WhileNode : StmtNode
+{
+    ExprNode* cond = nullptr;
+    vector<StmtNode*> body;
+
+    WhileNode(int line) : StmtNode(WHILE_NODE, line) {}
+};
+
+// FOR var IN low .. high LOOP body END LOOP. The loop variable has a slot of its own for the duration
+// of the loop; limitSlot is a hidden slot holding the upper bound, evaluated once before the first iteration
+struct ForNode : StmtNode
+{
+    int slot = 0;
+    int limitSlot = 0;
+    ExprNode* low = nullptr;
+    ExprNode* high = nullptr;
+    vector<StmtNode*> body;
+
+    ForNode(int line) : StmtNode(FOR_NODE, line) {}
+};
+
+// Root of a parsed procedure. Every node created while parsing it is carved from its arena, so one delete
+// releases the tree in a handful of frees. Each declared identifier (and the procedure name) has a dense
+// slot indexing varNames and varTypes
+struct ProgNode
+{
+    string name;
+    vector<string> varNames;
+    vector<Token> varTypes;
+    vector<StmtNode*> decls;
+    vector<StmtNode*> body;
+    Arena nodes{16384};
+
+    ProgNode() {}
+    ProgNode(const ProgNode&) = delete;
+    ProgNode& operator=(const ProgNode&) = delete;
+
+    int NumSlots() const { return (int)varNames.size(); }
+
+    template <class T, class... Args>
+    T* New(Args&&... args)
+    {
+        return nodes.New<T>(std::forward<Args>(args)...);
+    }
+};
+
+#endif
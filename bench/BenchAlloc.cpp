@@ -0,0 +1,117 @@
+/* Benchmark: heap allocations made while parsing and running, counted by replacing the global operator new */
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <cstdlib>
+#include <new>
+#include "../treeInterp.h"
+#include "bench.h"
+
+using namespace std;
+
+static size_t HeapAllocs = 0;
+
+void* operator new(size_t size)
+{
+    HeapAllocs++;
+    if (void* p = malloc(size ? size : 1))
+        return p;
+    throw bad_alloc();
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+// A loop of nstmts scalar statements, or string statements when strings is set, run iters times
+static string LoopProgram(int nstmts, int iters, bool strings)
+{
+    ostringstream src;
+    src << "procedure alloc is" << endl;
+    src << "  a, b, c : integer := 1;" << endl;
+    src << "  x, y : float := 2.5;" << endl;
+    src << "  s, t : string := \"fragment\";" << endl;
+    src << "  ok : boolean := true;" << endl;
+    src << "begin" << endl;
+    src << "  for i in 1 .. " << iters << " loop" << endl;
+    for (int k = 0; k < nstmts; k++)
+    {
+        if (strings)
+        {
+            src << "    t := s(0 .. " << k % 8 << ") & \"-\";" << endl;
+            src << "    ok := t = s;" << endl;
+        }
+        else
+        {
+            src << "    a := (b * " << k + 3 << " + c - i) mod 1000;" << endl;
+            src << "    x := y * 0.5 + x / 3.0 - a * 0.25;" << endl;
+        }
+        src << "    if a > b then c := c + 1; else b := b - 1; end if;" << endl;
+    }
+    src << "  end loop;" << endl;
+    src << "  putline(a);" << endl;
+    src << "end alloc;" << endl;
+    return src.str();
+}
+
+struct Counts
+{
+    size_t heap;
+    AllocStats stats;
+};
+
+template <class F>
+static Counts Count(F body)
+{
+    size_t heapBefore = HeapAllocs;
+    AllocStats before = Allocs;
+    body();
+    Counts counts{ HeapAllocs - heapBefore, Allocs };
+    counts.stats.arenaBlocks -= before.arenaBlocks;
+    counts.stats.arenaObjects -= before.arenaObjects;
+    counts.stats.heapStrings -= before.heapStrings;
+    counts.stats.pooledStrings -= before.pooledStrings;
+    return counts;
+}
+
+int main(int argc, char* argv[])
+{
+    int iters = argc > 1 ? stoi(argv[1]) : 10000;
+    const int nstmts = 20;
+
+    cout << left << setw(10) << "program" << setw(8) << "mode" << right << setw(14) << "stmts run"
+         << setw(14) << "heap allocs" << setw(14) << "per stmt" << setw(16) << "pooled strings" << endl;
+    for (bool strings : { false, true })
+    {
+        LexBuffer src(LoopProgram(nstmts, iters, strings));
+        int line = 1;
+        ProgNode* prog = nullptr;
+        Counts parse = Count([&] { ParseProg(src, line, prog); });
+        if (prog == nullptr)
+            return 1;
+
+        Chunk chunk;
+        CompileProg(prog, chunk);
+
+        QuietInterp quiet;
+        size_t stmtsRun = (size_t)iters * nstmts * 3;
+        const char* name = strings ? "string" : "scalar";
+
+        // The first run of each mode sizes the variable slots and the string pool; count the second
+        RunProg(prog);
+        Counts tree = Count([&] { RunProg(prog); });
+        RunChunk(chunk);
+        Counts vm = Count([&] { RunChunk(chunk); });
+
+        for (auto& row : { make_pair("tree", tree), make_pair("vm", vm) })
+        {
+            cout << left << setw(10) << name << setw(8) << row.first << right << setw(14) << stmtsRun
+                 << setw(14) << row.second.heap << setw(14) << fixed << setprecision(4)
+                 << (double)row.second.heap / stmtsRun << setw(16) << row.second.stats.pooledStrings << endl;
+        }
+        cout << left << setw(10) << name << setw(8) << "parse" << right << setw(14) << "" << setw(14) << parse.heap
+             << "  (" << parse.stats.arenaObjects << " arena objects in " << parse.stats.arenaBlocks << " blocks)" << endl;
+        delete prog;
+    }
+    return 0;
+}
@@ -0,0 +1,107 @@
+/* Benchmark: the columnar engine against running the same records one at a time on the bytecode */
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include "../columnar.h"
+#include "bench.h"
+
+using namespace std;
+
+// Pricing: a few statements per record, with IF arms taken by different records and a line of output each
+static const char* const Pricing =
+    "procedure pricing is\n"
+    "  id, qty, tier : integer;\n"
+    "  unit, total, tax : float;\n"
+    "  member : boolean;\n"
+    "begin\n"
+    "  get(id); get(qty); get(unit); get(member);\n"
+    "  total := unit * qty;\n"
+    "  if qty > 100 and member then total := total * 0.85; tier := 3;\n"
+    "  elsif qty > 20 or member then total := total * 0.95; tier := 2;\n"
+    "  else tier := 1; end if;\n"
+    "  tax := total * 0.08 + (qty mod 7) * 0.01;\n"
+    "  put(id); put(\" \"); put(tier); put(\" \"); putline(total + tax);\n"
+    "end pricing;\n";
+
+// Arithmetic: many integer and real statements per record and one line of output
+static string Arithmetic(int nstmts)
+{
+    ostringstream src;
+    src << "procedure arith is" << endl;
+    src << "  a, b, c, n : integer;" << endl;
+    src << "  x, y : float;" << endl;
+    src << "begin" << endl;
+    src << "  get(n); get(x);" << endl;
+    src << "  a := n; b := 1; c := 0; y := 1.5;" << endl;
+    for (int s = 0; s < nstmts; s++)
+    {
+        src << "  a := (b * " << s % 13 + 3 << " + c - n) mod 1000;" << endl;
+        src << "  x := y * 0.5 + x / 3.0 - a * 0.25;" << endl;
+        src << "  if a > b and x < 100.0 then c := c + 1; elsif x >= y then b := b - 1; else y := -y; end if;" << endl;
+    }
+    src << "  put(a); put(\" \"); putline(x);" << endl;
+    src << "end arith;" << endl;
+    return src.str();
+}
+
+// Parse once for both engines
+static bool Build(const string& source, CompiledProgram& prog, ColumnarProgram& columns)
+{
+    Interp ctx;
+    StringSink diagnostics;
+    ctx.Sink = &diagnostics;
+    InterpScope scope(ctx);
+
+    LexBuffer src{source};
+    int line = 1;
+    ProgNode* tree = nullptr;
+    string reason;
+    bool ok = ParseProg(src, line, tree) && CompileProg(tree, prog.chunk) && BuildColumnar(tree, columns, reason);
+    prog.ok = ok;
+    delete tree;
+    if (!ok)
+        cout << diagnostics.Text() << reason << endl;
+    return ok;
+}
+
+static bool Compare(const string& name, const string& source, const string& input, long nrecords)
+{
+    CompiledProgram prog;
+    ColumnarProgram columns;
+    if (!Build(source, prog, columns))
+        return false;
+
+    // Row at a time: the bytecode, compiled by the JIT tier once hot, on one thread
+    StringSink rows, cols;
+    StreamStats rowStats, colStats;
+    double rowTime = Seconds([&] { rowStats = RunParallel(prog, input, rows, 1); });
+    double colTime = Seconds([&] { colStats = RunColumnar(columns, prog, input, cols); });
+
+    if (rowStats.records != (uint64_t)nrecords || colStats.records != rowStats.records || rows.Text() != cols.Text())
+        return false;
+
+    cout << left << setw(12) << name << right << fixed << setprecision(3) << setw(12) << rowTime
+         << setw(12) << colTime << setprecision(1) << setw(14) << nrecords / colTime / 1e3
+         << setw(10) << rowTime / colTime << "x" << endl;
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    long nrecords = argc > 1 ? stol(argv[1]) : 200000;
+
+    string orders, samples;
+    for (long i = 0; i < nrecords; i++)
+    {
+        orders += to_string(i) + " " + to_string(i % 150) + " " + to_string(i % 40) + ".5 " + (i % 3 ? "true" : "false") + "\n";
+        samples += to_string(i % 1000) + " " + to_string(i % 17) + ".25\n";
+    }
+
+    cout << "records: " << nrecords << " in batches of " << ColumnRows << endl;
+    cout << left << setw(12) << "program" << right << setw(12) << "rows s" << setw(12) << "columns s"
+         << setw(14) << "Krecords/s" << setw(11) << "speedup" << endl;
+    if (!Compare("pricing", Pricing, orders, nrecords) || !Compare("arithmetic", Arithmetic(40), samples, nrecords))
+        return 1;
+    return 0;
+}
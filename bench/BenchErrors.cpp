@@ -0,0 +1,127 @@
+/* Benchmark: relational and mixed-type expression throughput with errors returned as values instead of thrown */
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../treeInterp.h"
+#include "bench.h"
+
+using namespace std;
+
+// The operators as they were: <= and >= threw when < had no boolean answer, and every use sat in a try block
+static Value ThrowingLte(const Value& a, const Value& b)
+{
+    Value less = a < b;
+    if (!less.IsBool())
+        throw "RUNTIME ERROR: Value not a Boolean";
+    return Value(less.GetBool() || (a == b).GetBool());
+}
+
+static Value ThrowingGte(const Value& a, const Value& b)
+{
+    Value less = a < b;
+    if (!less.IsBool())
+        throw "RUNTIME ERROR: Value not a Boolean";
+    return Value(!less.GetBool());
+}
+
+// Valid procedure dominated by comparisons and boolean logic, mixing integer and float operands
+// so the VM keeps the generic opcodes for part of them
+static string RelationalProgram(int nvars, int nstmts)
+{
+    ostringstream src;
+    src << "procedure rel is" << endl;
+    for (int i = 0; i < nvars; i++)
+    {
+        src << "  i" << i << " : integer := " << i * 3 + 1 << ";" << endl;
+        src << "  f" << i << " : float := " << i << ".75;" << endl;
+        src << "  b" << i << " : boolean := true;" << endl;
+    }
+    src << "begin" << endl;
+    for (int s = 0; s < nstmts; s++)
+    {
+        int a = s % nvars, b = (s * 7 + 3) % nvars, c = (s * 13 + 5) % nvars;
+        src << "  b" << a << " := (i" << b << " <= f" << c << " or f" << a << " > i" << c << ") and not (i"
+            << a << " >= i" << b << " / 2);" << endl;
+        src << "  b" << b << " := b" << a << " or (f" << b << " <= f" << c << " and i" << c << " > i" << a << " mod 7);" << endl;
+        if (s % 8 == 0)
+        {
+            src << "  if b" << a << " and i" << a << " > i" << b << " then" << endl;
+            src << "    i" << c << " := i" << c << " + 1;" << endl;
+            src << "  end if;" << endl;
+        }
+    }
+    src << "  putline(b0);" << endl;
+    src << "end rel;" << endl;
+    return src.str();
+}
+
+int main(int argc, char* argv[])
+{
+    int runs = argc > 1 ? stoi(argv[1]) : 200;
+
+    vector<Value> operands = { Value(3), Value(2.5), Value(7), Value(-1.25), Value(3.0), Value(11) };
+    const int rounds = 2000000;
+    size_t trueCount = 0, trueCountOld = 0;
+    double thrown = TimeRuns(1, [&] {
+        for (int r = 0; r < rounds; r++)
+        {
+            const Value& a = operands[r % 6];
+            const Value& b = operands[(r + 1) % 6];
+            try
+            {
+                trueCountOld += ThrowingLte(a, b).GetBool() + ThrowingGte(b, a).GetBool();
+            }
+            catch (const char*)
+            {
+                return false;
+            }
+        }
+        return true;
+    });
+    double returned = TimeRuns(1, [&] {
+        for (int r = 0; r < rounds; r++)
+        {
+            const Value& a = operands[r % 6];
+            const Value& b = operands[(r + 1) % 6];
+            Value lte = a <= b, gte = b >= a;
+            if (lte.Raised() || gte.Raised())
+                return false;
+            trueCount += lte.GetBool() + gte.GetBool();
+        }
+        return true;
+    });
+    if (trueCount != trueCountOld)
+    {
+        cout << "MISMATCH between thrown and returned errors" << endl;
+        return 1;
+    }
+    cout << fixed << setprecision(1);
+    cout << "<= and >= with try/catch:  " << setw(8) << 2 * rounds / thrown / 1e3 << " M ops/s" << endl;
+    cout << "<= and >= with Raised():   " << setw(8) << 2 * rounds / returned / 1e3 << " M ops/s" << endl << endl;
+
+    cout << left << setw(22) << "program" << right << setw(14) << "tree ms/run" << setw(14) << "vm ms/run"
+         << setw(16) << "tree Mstmt/s" << setw(14) << "vm Mstmt/s" << endl;
+    const int sizes[][2] = { {20, 500}, {100, 5000} };
+    for (auto& size : sizes)
+    {
+        BenchProgram prog(RelationalProgram(size[0], size[1]));
+        if (!prog.ok)
+            return 1;
+
+        double tree, vm;
+        {
+            QuietInterp quiet;
+            tree = TimeRuns(runs, [&] { return RunProg(prog.tree); });
+            vm = TimeRuns(runs, [&] { return RunChunk(prog.chunk); });
+        }
+        size_t stmts = prog.tree->decls.size() + prog.tree->body.size();
+
+        ostringstream name;
+        name << size[0] * 3 << " vars/" << size[1] << " stmts";
+        cout << left << setw(22) << name.str() << right << setprecision(3) << setw(14) << tree << setw(14) << vm
+             << setprecision(2) << setw(16) << stmts / tree / 1e3 << setw(14) << stmts / vm / 1e3 << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,85 @@
+/* Benchmark: a program run repeatedly through the embedding API, before and after the JIT tier compiles it */
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include "../program.h"
+#include "bench.h"
+
+using namespace std;
+
+// Straight-line integer and float assignments and IFs, with one PUT and one GET left to the VM
+static string HotProgram(int nstmts)
+{
+    ostringstream src;
+    src << "procedure hot is" << endl;
+    src << "  a, b, c : integer := 1;" << endl;
+    src << "  x, y : float := 2.5;" << endl;
+    src << "  n : integer;" << endl;
+    src << "begin" << endl;
+    src << "  get(n);" << endl;
+    for (int s = 0; s < nstmts; s++)
+    {
+        src << "  a := (b * " << s % 13 + 3 << " + c - n) mod 1000;" << endl;
+        src << "  x := y * 0.5 + x / 3.0 - a * 0.25;" << endl;
+        src << "  if a > b and x < 100.0 then c := c + 1; elsif x >= y then b := b - 1; else y := -y; end if;" << endl;
+    }
+    src << "  putline(a);" << endl;
+    src << "end hot;" << endl;
+    return src.str();
+}
+
+int main(int argc, char* argv[])
+{
+    int runs = argc > 1 ? stoi(argv[1]) : 2000;
+    const int nstmts = 200;
+    CompiledProgram prog = Compile(HotProgram(nstmts));
+    if (!prog.ok)
+    {
+        cout << prog.diagnostics;
+        return 1;
+    }
+
+    NullSink null;
+    const string text = "17";
+    auto timeRun = [&] {
+        InputSource input(text);
+        bool ok = false;
+        double elapsed = Seconds([&] { ok = Run(prog, input, null); });
+        return ok ? elapsed * 1e6 : -1.0;
+    };
+
+    // Runs up to the threshold are interpreted; the one reaching it compiles, the rest run machine code
+    uint64_t threshold = JitThreshold.load();
+    double cold = 0, compile = 0, hot = 0;
+    int coldRuns = 0, hotRuns = 0;
+    for (int r = 1; r <= runs; r++)
+    {
+        bool wasCompiled = prog.tier.Compiled();
+        double us = timeRun();
+        if (us < 0)
+            return 1;
+        if ((uint64_t)r == threshold)
+            compile = us;
+        else if (wasCompiled)
+        {
+            hot += us;
+            hotRuns++;
+        }
+        else
+        {
+            cold += us;
+            coldRuns++;
+        }
+    }
+
+    cout << "program: " << nstmts * 3 << " statements, " << prog.chunk.code.size() << " instructions, threshold "
+         << threshold << " runs" << endl;
+    cout << fixed << setprecision(2);
+    cout << left << setw(24) << "vm (cold) us/run" << right << setw(10) << (coldRuns ? cold / coldRuns : 0.0) << endl;
+    cout << left << setw(24) << "compiling run us" << right << setw(10) << compile << endl;
+    cout << left << setw(24) << "jit (hot) us/run" << right << setw(10) << (hotRuns ? hot / hotRuns : 0.0) << endl;
+    if (coldRuns && hotRuns)
+        cout << left << setw(24) << "speedup" << right << setw(9) << (cold / coldRuns) / (hot / hotRuns) << "x" << endl;
+    return 0;
+}
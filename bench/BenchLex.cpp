@@ -0,0 +1,120 @@
+/* Microbenchmark: reserved word recognition and lexer throughput on an identifier-heavy corpus */
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <random>
+#include "../lex.h"
+#include "bench.h"
+
+using namespace std;
+
+// The table lookup id_or_kw used before: lowercase into a buffer, then search the keywords map
+static Token MapKeyword(string_view lexeme)
+{
+    const size_t maxKeyword = 9;
+    if (lexeme.size() > maxKeyword)
+        return IDENT;
+
+    char lower[maxKeyword];
+    for (size_t i = 0; i < lexeme.size(); i++)
+        lower[i] = tolower(lexeme[i]);
+
+    auto it = keywords.find(string_view(lower, lexeme.size()));
+    return it == keywords.end() ? IDENT : it->second;
+}
+
+// Identifiers of varied length and case, with about one word in five a reserved word
+static vector<string> Corpus(size_t nwords)
+{
+    static const char* reserved[] =
+    {
+        "if", "then", "else", "elsif", "end", "put", "putline", "get", "integer", "float",
+        "character", "string", "boolean", "procedure", "is", "begin", "and", "or", "not", "mod"
+    };
+    static const char* stems[] =
+    {
+        "i", "x", "total", "count", "index", "Item", "PUT_X", "endval", "is_ok", "floaty",
+        "character_count", "begin2", "ThenPart", "modulo", "notes", "result", "sum", "tmp", "Balance", "str"
+    };
+
+    mt19937 rng(280);
+    vector<string> words;
+    words.reserve(nwords);
+    for (size_t i = 0; i < nwords; i++)
+    {
+        if (rng() % 5 == 0)
+        {
+            string w = reserved[rng() % 20];
+            if (rng() % 4 == 0)
+                w[0] = toupper(w[0]);
+            words.push_back(w);
+        }
+        else
+            words.push_back(string(stems[rng() % 20]) + to_string(rng() % 100));
+    }
+    return words;
+}
+
+int main(int argc, char* argv[])
+{
+    size_t nwords = argc > 1 ? stoul(argv[1]) : 2000000;
+    int rounds = 5;
+    vector<string> words = Corpus(nwords);
+
+    for (auto& kw : keywords)
+    {
+        string upper = kw.first;
+        for (char& c : upper)
+            c = toupper(c);
+        Token expect = (kw.second == TRUE || kw.second == FALSE) ? BCONST : kw.second;
+        if (id_or_kw(kw.first, 1).GetToken() != expect || id_or_kw(upper, 1).GetToken() != expect)
+        {
+            cout << "MISMATCH on reserved word " << kw.first << endl;
+            return 1;
+        }
+    }
+
+    size_t mapKeywords = 0, switchKeywords = 0;
+    double mapTime = Seconds([&] {
+        for (int r = 0; r < rounds; r++)
+            for (const string& w : words)
+                mapKeywords += MapKeyword(w) != IDENT;
+    });
+    double switchTime = Seconds([&] {
+        for (int r = 0; r < rounds; r++)
+            for (const string& w : words)
+                switchKeywords += id_or_kw(w, 1).GetToken() != IDENT;
+    });
+    if (mapKeywords != switchKeywords)
+    {
+        cout << "MISMATCH: map found " << mapKeywords << " reserved words, switch found " << switchKeywords << endl;
+        return 1;
+    }
+
+    string text;
+    for (size_t i = 0; i < words.size(); i++)
+        text += words[i] + ((i % 8 == 7) ? " ;\n" : " ");
+
+    size_t tokens = 0;
+    double lexTime = Seconds([&] {
+        for (int r = 0; r < rounds; r++)
+        {
+            LexBuffer src(text);
+            int line = 1;
+            while (getNextToken(src, line) != DONE)
+                tokens++;
+        }
+    });
+
+    double lookups = (double)words.size() * rounds;
+    cout << fixed << setprecision(1);
+    cout << "corpus: " << words.size() << " words, " << mapKeywords / rounds << " reserved" << endl;
+    cout << "map lookup:     " << setw(8) << lookups / mapTime / 1e6 << " M lookups/s" << endl;
+    cout << "switch lookup:  " << setw(8) << lookups / switchTime / 1e6 << " M lookups/s  ("
+         << setprecision(2) << mapTime / switchTime << "x)" << endl;
+    cout << setprecision(1);
+    cout << "getNextToken:   " << setw(8) << tokens / lexTime / 1e6 << " M tokens/s, "
+         << text.size() * rounds / lexTime / 1e6 << " MB/s" << endl;
+    return 0;
+}
@@ -0,0 +1,70 @@
+/* Benchmark: tree-walking evaluator and bytecode VM versus procedures built by the native backend */
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <cstdio>
+#include <unistd.h>
+#include "../treeInterp.h"
+#include "../native.h"
+#include "bench.h"
+
+using namespace std;
+
+// A loop over integer and float arithmetic and an IF, with a string built every iteration when strings is set
+static string LoopProgram(int iters, bool strings)
+{
+    ostringstream src;
+    src << "procedure hot is" << endl;
+    src << "  a, b, c : integer := 1;" << endl;
+    src << "  x, y : float := 2.5;" << endl;
+    src << "  s : string := \"fragment\";" << endl;
+    src << "begin" << endl;
+    src << "  for i in 1 .. " << iters << " loop" << endl;
+    src << "    a := (b * 7 + c - i) mod 1000;" << endl;
+    src << "    x := y * 0.5 + x / 3.0 - a * 0.25;" << endl;
+    src << "    if a > b then c := c + 1; else b := b - 1; end if;" << endl;
+    if (strings)
+        src << "    s := s(0 .. 3) & \"-\" & s(4 .. 7);" << endl;
+    src << "  end loop;" << endl;
+    src << "  putline(a);" << endl;
+    src << "end hot;" << endl;
+    return src.str();
+}
+
+int main(int argc, char* argv[])
+{
+    int runs = argc > 1 ? stoi(argv[1]) : 20;
+    const int iters = 100000;
+    string object = "bench_native_" + to_string(getpid()) + ".so";
+
+    cout << left << setw(10) << "program" << right << setw(12) << "build ms" << setw(14) << "tree ms/run"
+         << setw(14) << "vm ms/run" << setw(16) << "native ms/run" << setw(14) << "vs vm" << endl;
+    for (bool strings : { false, true })
+    {
+        BenchProgram prog(LoopProgram(iters, strings));
+        if (!prog.ok)
+            return 1;
+
+        string log;
+        NativeProgram native;
+        bool built = false;
+        double build = 1e3 * Seconds([&] { built = BuildNative(prog.tree, object, log) && native.Load(object, log); });
+        remove(object.c_str());
+        if (!built)
+        {
+            cout << log << endl;
+            return 1;
+        }
+
+        QuietInterp quiet;
+        double tree = TimeRuns(runs, [&] { return RunProg(prog.tree); });
+        double vm = TimeRuns(runs, [&] { return RunChunk(prog.chunk); });
+        double compiled = TimeRuns(runs, [&] { return native.Run(); });
+
+        cout << left << setw(10) << (strings ? "string" : "scalar") << right << fixed << setprecision(1)
+             << setw(12) << build << setprecision(3) << setw(14) << tree << setw(14) << vm
+             << setw(16) << compiled << setw(13) << setprecision(1) << vm / compiled << "x" << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,64 @@
+/* Benchmark: records run on worker threads with work stealing, against the single-threaded stream */
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <thread>
+#include "../program.h"
+#include "bench.h"
+
+using namespace std;
+
+// Records that cost very different amounts: every 64th one loops a thousand times longer, so an even split of
+// the input leaves some workers with far more to do than others
+static const char* const Source =
+    "procedure skewed is\n"
+    "  id, n, i : integer;\n"
+    "  sum : float := 0.0;\n"
+    "begin\n"
+    "  get(id); get(n);\n"
+    "  i := 0;\n"
+    "  while i < n loop sum := sum + i * 0.5; i := i + 1; end loop;\n"
+    "  put(id); put(\" \"); putline(sum);\n"
+    "end skewed;\n";
+
+int main(int argc, char* argv[])
+{
+    long nrecords = argc > 1 ? stol(argv[1]) : 200000;
+    CompiledProgram prog = Compile(Source);
+    if (!prog.ok)
+    {
+        cout << prog.diagnostics;
+        return 1;
+    }
+
+    string input;
+    for (long i = 0; i < nrecords; i++)
+        input += to_string(i) + " " + to_string(i % 64 == 0 ? 2000 : 2) + "\n";
+
+    // The stream run's output, to check that every worker count writes the same thing in the same order
+    istringstream in(input);
+    ostringstream expected;
+    double streamed = Seconds([&] { RunStream(prog, in, expected); });
+
+    unsigned cores = max(1u, thread::hardware_concurrency());
+    cout << "records: " << nrecords << ", cores: " << cores << endl;
+    cout << left << setw(16) << "run" << right << setw(12) << "seconds" << setw(14) << "Krecords/s" << setw(10) << "speedup" << endl;
+    cout << fixed;
+    cout << left << setw(16) << "stream" << right << setprecision(3) << setw(12) << streamed << setprecision(1)
+         << setw(14) << nrecords / streamed / 1e3 << setw(10) << 1.0 << endl;
+
+    for (unsigned workers : { 1u, 2u, 4u, cores })
+    {
+        StringSink sink;
+        StreamStats stats;
+        double elapsed = Seconds([&] { stats = RunParallel(prog, input, sink, workers); });
+        if (stats.records != (uint64_t)nrecords || stats.failed != 0 || sink.Text() != expected.str())
+            return 1;
+
+        string name = to_string(workers) + (workers == 1 ? " worker" : " workers");
+        cout << left << setw(16) << name << right << setprecision(3) << setw(12) << elapsed << setprecision(1)
+             << setw(14) << nrecords / elapsed / 1e3 << setw(10) << streamed / elapsed << endl;
+    }
+    return 0;
+}
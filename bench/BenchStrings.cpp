@@ -0,0 +1,63 @@
+/* Benchmark: building long strings with & and slicing them, with values copying their text versus sharing buffers */
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include "../treeInterp.h"
+#include "bench.h"
+
+using namespace std;
+
+// A report script: append nfrags fragments to one string, slicing a field out of the result as it grows
+static string ReportProgram(int nfrags)
+{
+    ostringstream src;
+    src << "procedure report is" << endl;
+    src << "  s, field : string := \"\";" << endl;
+    src << "  total : integer := 0;" << endl;
+    src << "begin" << endl;
+    src << "  for i in 1 .. " << nfrags << " loop" << endl;
+    src << "    s := s & \"row \" & \"value;\";" << endl;
+    src << "    if i mod 100 = 0 then" << endl;
+    src << "      field := s(4 .. 8);" << endl;
+    src << "      total := total + 1;" << endl;
+    src << "    end if;" << endl;
+    src << "  end loop;" << endl;
+    src << "  putline(s(0 .. 9));" << endl;
+    src << "  putline(field);" << endl;
+    src << "  putline(total);" << endl;
+    src << "end report;" << endl;
+    return src.str();
+}
+
+int main(int argc, char* argv[])
+{
+    int maxFrags = argc > 1 ? stoi(argv[1]) : 40000;
+
+    cout << left << setw(12) << "fragments" << right << setw(16) << "copying ms" << setw(14) << "tree ms"
+         << setw(14) << "vm ms" << setw(14) << "MB built" << endl;
+    for (int nfrags = maxFrags / 16; nfrags <= maxFrags; nfrags *= 4)
+    {
+        // What each & cost before: a fresh string holding both operands
+        string copied;
+        double copying = 1e3 * Seconds([&] {
+            for (int i = 0; i < nfrags; i++)
+                copied = copied + "row " + "value;";
+        });
+
+        BenchProgram prog(ReportProgram(nfrags));
+        if (!prog.ok)
+            return 1;
+
+        double tree, vm;
+        {
+            QuietInterp quiet;
+            tree = 1e3 * Seconds([&] { RunProg(prog.tree); });
+            vm = 1e3 * Seconds([&] { RunChunk(prog.chunk); });
+        }
+
+        cout << left << setw(12) << nfrags << right << fixed << setprecision(2) << setw(16) << copying
+             << setw(14) << tree << setw(14) << vm << setw(14) << copied.size() / 1e6 << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,256 @@
+/* Benchmark suite: generated SADAL programs stressing one part of the interpreter each, with throughput and peak RSS */
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include "../treeInterp.h"
+#include "../profile.h"
+#include "bench.h"
+
+using namespace std;
+
+struct Corpus
+{
+    const char* name;
+    string source;
+};
+
+// Long identifiers, numeric and string literals and comments on every line
+static Corpus Lexing(int scale)
+{
+    ostringstream src;
+    int nvars = 50;
+    src << "procedure lexing is" << endl;
+    for (int i = 0; i < nvars; i++)
+        src << "  accumulated_total_" << i << " : float := " << i << ".125; -- running sum number " << i << endl;
+    src << "  label_text : string := \"\";" << endl;
+    src << "begin" << endl;
+    for (int s = 0; s < 20000 * scale; s++)
+    {
+        int a = s % nvars, b = (s * 7 + 1) % nvars;
+        src << "  -- statement " << s << " updates accumulated_total_" << a << endl;
+        src << "  accumulated_total_" << a << " := accumulated_total_" << b << " * 0.5 + 1234.5678 - 2.5E2 / 100.0;" << endl;
+        if (s % 16 == 0)
+            src << "  label_text := \"line " << s << " of the lexing corpus\";" << endl;
+    }
+    src << "  putline(accumulated_total_0);" << endl;
+    src << "end lexing;" << endl;
+    return { "lexing", src.str() };
+}
+
+// A declarative part dominating the program
+static Corpus Declarations(int scale)
+{
+    ostringstream src;
+    src << "procedure decls is" << endl;
+    for (int i = 0; i < 20000 * scale; i++)
+    {
+        switch (i % 4)
+        {
+            case 0: src << "  count_" << i << ", extra_" << i << " : integer := " << i << ";" << endl; break;
+            case 1: src << "  ratio_" << i << " : float := " << i << ".5;" << endl; break;
+            case 2: src << "  name_" << i << " : string := \"n" << i << "\";" << endl; break;
+            case 3: src << "  flag_" << i << " : boolean := true;" << endl; break;
+        }
+    }
+    src << "begin" << endl;
+    src << "  putline(count_0);" << endl;
+    src << "end decls;" << endl;
+    return { "declarations", src.str() };
+}
+
+// Expressions nested depth levels deep, evaluated in a loop
+static Corpus DeepExpressions(int scale)
+{
+    const int depth = 40;
+    ostringstream src;
+    src << "procedure deep is" << endl;
+    src << "  x, y : integer := 3;" << endl;
+    src << "  r : float := 1.5;" << endl;
+    src << "begin" << endl;
+    src << "  for i in 1 .. " << 200 * scale << " loop" << endl;
+    for (int s = 0; s < 20; s++)
+    {
+        src << "    x := ";
+        for (int d = 0; d < depth; d++)
+            src << "(";
+        src << "y";
+        for (int d = 0; d < depth; d++)
+            src << (d % 3 == 0 ? " + " : d % 3 == 1 ? " * " : " - ") << (d % 7 + 1) << ") mod 1013";
+        src << ";" << endl;
+        src << "    r := ((((r * 0.5 + 1.0) / 1.5 - 0.25) * (r + 2.0)) / (r + 3.0)) + ((r - 1.0) * 0.125);" << endl;
+        src << "    y := x + i;" << endl;
+    }
+    src << "  end loop;" << endl;
+    src << "  putline(x);" << endl;
+    src << "end deep;" << endl;
+    return { "deep expressions", src.str() };
+}
+
+// Nested IFs whose outer conditions are false, so most of the tree is skipped
+static Corpus NestedIfs(int scale)
+{
+    const int depth = 12;
+    ostringstream src;
+    src << "procedure nested is" << endl;
+    src << "  a, count : integer := 0;" << endl;
+    src << "  flag : boolean := false;" << endl;
+    src << "begin" << endl;
+    src << "  for i in 1 .. " << 100 * scale << " loop" << endl;
+    for (int block = 0; block < 50; block++)
+    {
+        for (int d = 0; d < depth; d++)
+        {
+            src << string(4 + 2 * d, ' ') << "if " << (d == 0 ? "flag" : "a > " + to_string(d)) << " then" << endl;
+            src << string(6 + 2 * d, ' ') << "a := a + " << d << ";" << endl;
+        }
+        for (int d = depth - 1; d >= 0; d--)
+        {
+            src << string(4 + 2 * d, ' ') << "elsif a = " << d << " then" << endl;
+            src << string(6 + 2 * d, ' ') << "a := 0;" << endl;
+            src << string(4 + 2 * d, ' ') << "else" << endl;
+            src << string(6 + 2 * d, ' ') << "count := count + 1;" << endl;
+            src << string(4 + 2 * d, ' ') << "end if;" << endl;
+        }
+    }
+    src << "  end loop;" << endl;
+    src << "  putline(count);" << endl;
+    src << "end nested;" << endl;
+    return { "nested if", src.str() };
+}
+
+// One string grown by thousands of appends, sliced as it grows
+static Corpus Concatenation(int scale)
+{
+    ostringstream src;
+    src << "procedure concat is" << endl;
+    src << "  report, field : string := \"\";" << endl;
+    src << "begin" << endl;
+    src << "  for i in 1 .. " << 20000 * scale << " loop" << endl;
+    src << "    report := report & \"row \" & \"value;\";" << endl;
+    src << "    field := report(0 .. 7) & \"|\";" << endl;
+    src << "  end loop;" << endl;
+    src << "  putline(field);" << endl;
+    src << "end concat;" << endl;
+    return { "concatenation", src.str() };
+}
+
+// PUT and PUTLINE of every value type
+static Corpus Output(int scale)
+{
+    ostringstream src;
+    src << "procedure output is" << endl;
+    src << "  x : float := 0.25;" << endl;
+    src << "  c : character := 'c';" << endl;
+    src << "  s : string := \"value\";" << endl;
+    src << "begin" << endl;
+    src << "  for i in 1 .. " << 20000 * scale << " loop" << endl;
+    src << "    put(i); put(\" \"); put(s); put(c);" << endl;
+    src << "    x := x * 1.5 + 0.75;" << endl;
+    src << "    putline(x);" << endl;
+    src << "  end loop;" << endl;
+    src << "end output;" << endl;
+    return { "output volume", src.str() };
+}
+
+// Seconds per run of body, repeating it until a fifth of a second has passed
+template <class F>
+static double PerRun(F body)
+{
+    int runs = 0;
+    double total = 0;
+    while (total < 0.2)
+    {
+        total += Seconds(body);
+        runs++;
+    }
+    return total / runs;
+}
+
+// Measure one corpus, printing everything but the peak RSS. False on a parse or run failure
+static bool Measure(const Corpus& corpus)
+{
+    size_t tokens = 0;
+    double lexTime = PerRun([&] {
+        LexBuffer src(corpus.source);
+        int line = 1;
+        tokens = 0;
+        while (getNextToken(src, line) != DONE)
+            tokens++;
+    });
+
+    ProgNode* prog = nullptr;
+    double parseTime = PerRun([&] {
+        delete prog;
+        LexBuffer src(corpus.source);
+        int line = 1;
+        ParseProg(src, line, prog);
+    });
+    if (prog == nullptr)
+        return false;
+
+    Chunk chunk;
+    CompileProg(prog, chunk);
+
+    NullSink null;
+    Profiler profiler;
+    Interp ctx;
+    ctx.Sink = &null;
+    InterpScope scope(ctx);
+
+    ctx.Prof = &profiler;
+    bool ok = RunProg(prog);
+    ctx.Prof = nullptr;
+    double executed = profiler.Executed();
+
+    double tree = PerRun([&] { ok = ok && RunProg(prog); });
+    double vm = PerRun([&] { ok = ok && RunChunk(chunk); });
+    delete prog;
+
+    cout << left << setw(18) << corpus.name << right << fixed << setprecision(2)
+         << setw(10) << tokens / 1e3 << setw(10) << tokens / lexTime / 1e6 << setw(10) << parseTime * 1e3
+         << setw(10) << executed / 1e3 << setw(12) << executed / tree / 1e6 << setw(12) << executed / vm / 1e6;
+    return ok;
+}
+
+int main(int argc, char* argv[])
+{
+    int scale = argc > 1 ? stoi(argv[1]) : 1;
+    Corpus (*corpora[])(int) = { Lexing, Declarations, DeepExpressions, NestedIfs, Concatenation, Output };
+
+    cout << left << setw(18) << "corpus" << right << setw(10) << "Ktokens" << setw(10) << "Mtok/s"
+         << setw(10) << "parse ms" << setw(10) << "Kstmts" << setw(12) << "tree Mst/s" << setw(12) << "vm Mst/s"
+         << setw(12) << "peak RSS MB" << endl;
+
+    // Each corpus runs in a child process of its own, so its peak RSS is not masked by the others
+    int failures = 0;
+    for (auto generate : corpora)
+    {
+        cout.flush();
+        pid_t pid = fork();
+        if (pid < 0)
+            return 1;
+        if (pid == 0)
+        {
+            bool ok = Measure(generate(scale));
+            cout.flush();
+            _exit(ok ? 0 : 1);
+        }
+
+        int status = 0;
+        struct rusage usage;
+        wait4(pid, &status, 0, &usage);
+        cout << setw(12) << fixed << setprecision(1) << usage.ru_maxrss / 1024.0;
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        {
+            cout << "  FAILED";
+            failures++;
+        }
+        cout << endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,71 @@
+/* Benchmark: tree-walking evaluator versus bytecode VM on arithmetic-heavy programs */
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include "../treeInterp.h"
+#include "bench.h"
+
+using namespace std;
+
+// Generate a procedure with nvars integer and float variables and nstmts assignments over deep expressions
+static string ArithProgram(int nvars, int nstmts)
+{
+    ostringstream src;
+    src << "procedure arith is" << endl;
+    for (int i = 0; i < nvars; i++)
+    {
+        src << "  i" << i << " : integer := " << i + 1 << ";" << endl;
+        src << "  f" << i << " : float := " << i + 1 << ".5;" << endl;
+    }
+    src << "begin" << endl;
+    for (int s = 0; s < nstmts; s++)
+    {
+        int a = s % nvars, b = (s * 7 + 3) % nvars, c = (s * 13 + 5) % nvars;
+        src << "  i" << a << " := (i" << b << " * 3 + i" << c << " - " << s % 17 << ") mod 1000 + (i" << c << " - i" << b << ") / 7;" << endl;
+        src << "  f" << b << " := f" << a << " * 0.5 + f" << c << " / 3.0 - i" << a << " * 0.25 + 1.0;" << endl;
+        if (s % 10 == 0)
+        {
+            src << "  if i" << a << " > i" << b << " and f" << c << " < 100.0 then" << endl;
+            src << "    i" << c << " := i" << a << " - i" << b << ";" << endl;
+            src << "  elsif f" << a << " >= f" << b << " then" << endl;
+            src << "    f" << c << " := 1.0;" << endl;
+            src << "  else" << endl;
+            src << "    i" << c << " := 0;" << endl;
+            src << "  end if;" << endl;
+        }
+    }
+    src << "  putline(i0);" << endl;
+    src << "  putline(f0);" << endl;
+    src << "end arith;" << endl;
+    return src.str();
+}
+
+int main(int argc, char* argv[])
+{
+    int runs = argc > 1 ? stoi(argv[1]) : 200;
+    const int sizes[][2] = { {10, 100}, {50, 1000}, {200, 5000} };
+
+    cout << left << setw(22) << "program" << right << setw(14) << "tree ms/run" << setw(14) << "vm ms/run"
+         << setw(10) << "speedup" << endl;
+
+    for (auto& size : sizes)
+    {
+        BenchProgram prog(ArithProgram(size[0], size[1]));
+        if (!prog.ok)
+            return 1;
+
+        double tree, vm;
+        {
+            QuietInterp quiet;
+            tree = TimeRuns(runs, [&] { return RunProg(prog.tree); });
+            vm = TimeRuns(runs, [&] { return RunChunk(prog.chunk); });
+        }
+
+        ostringstream name;
+        name << size[0] * 2 << " vars/" << size[1] << " stmts";
+        cout << left << setw(22) << name.str() << right << fixed << setprecision(3)
+             << setw(14) << tree << setw(14) << vm << setw(9) << setprecision(2) << tree / vm << "x" << endl;
+    }
+    return 0;
+}
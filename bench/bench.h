@@ -0,0 +1,76 @@
+// Header file for what the benchmark programs share: a discarding sink, timers and a parsed and compiled program
+#ifndef BENCH_H_
+#define BENCH_H_
+
+#include <string>
+#include <chrono>
+#include "../parserInterp.h"
+#include "../vm.h"
+#include "../interp.h"
+#include "../output.h"
+
+using namespace std;
+
+// Sink that discards everything, so PUT output does not dominate the timing
+class NullSink : public OutputSink
+{
+protected:
+    void Emit(const char*, size_t) override {}
+};
+
+// Seconds taken by one call of body
+template <class F>
+inline double Seconds(F body)
+{
+    auto start = chrono::steady_clock::now();
+    body();
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+// Milliseconds per call of run, called runs times; -1 as soon as a call returns false
+template <class F>
+inline double TimeRuns(int runs, F run)
+{
+    auto start = chrono::steady_clock::now();
+    for (int r = 0; r < runs; r++)
+    {
+        if (!run())
+            return -1;
+    }
+    chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+    return elapsed.count() / runs;
+}
+
+// A generated procedure parsed to a tree and compiled to bytecode, so both engines can run it. ok is false
+// when it does not parse
+struct BenchProgram
+{
+    ProgNode* tree = nullptr;
+    Chunk chunk;
+    bool ok = false;
+
+    explicit BenchProgram(const string& source)
+    {
+        LexBuffer src(source);
+        int line = 1;
+        ok = ParseProg(src, line, tree);
+        if (ok)
+            CompileProg(tree, chunk);
+    }
+    ~BenchProgram() { delete tree; }
+    BenchProgram(const BenchProgram&) = delete;
+    BenchProgram& operator=(const BenchProgram&) = delete;
+};
+
+// An interpreter context whose output is discarded, installed on the calling thread for its lifetime
+struct QuietInterp
+{
+    NullSink null;
+    Interp ctx;
+    InterpScope scope{ ctx };
+
+    QuietInterp() { ctx.Sink = &null; }
+};
+
+#endif
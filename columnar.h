@@ -0,0 +1,80 @@
+// Header file for the columnar engine in Columnar.cpp: a procedure run over a batch of records at once
+#ifndef COLUMNAR_H_
+#define COLUMNAR_H_
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include "ast.h"
+#include "program.h"
+
+using namespace std;
+
+// Records of a batch, and so the length of every column
+const int ColumnRows = 1024;
+
+// Kernels over whole columns: integer (I), real (F) and boolean (B) arithmetic, comparisons and logic.
+// I2F widens an integer column for mixed arithmetic. Integer operations use the wrapping helpers in val.h,
+// as every engine does, so only a zero divisor fails a record
+enum ColOpcode : uint8_t
+{
+    COL_ADDI, COL_SUBI, COL_MULI, COL_DIVI, COL_MODI, COL_NEGI, COL_I2F,
+    COL_ADDF, COL_SUBF, COL_MULF, COL_DIVF, COL_NEGF, COL_POWF,
+    COL_EQI, COL_NEI, COL_LTI, COL_LEI, COL_GTI, COL_GEI,
+    COL_EQF, COL_NEF, COL_LTF, COL_LEF, COL_GTF, COL_GEF,
+    COL_EQB, COL_NEB, COL_AND, COL_OR, COL_NOT
+};
+
+// A column of INT, FLOAT or BOOL values: a variable or constant kept for the whole run, or a temporary of
+// one statement
+struct ColReg
+{
+    Token type = ERR;
+    bool temp = false;
+    uint16_t index = 0;
+};
+
+struct ColOp
+{
+    ColOpcode op;
+    ColReg dst, a, b;
+};
+
+// A statement over columns. code computes value: the expression assigned or printed, or the condition;
+// for FOR, value and limit are the bounds and targets the loop variable and the hidden slot for its limit
+struct ColStmt
+{
+    NodeKind kind;
+    vector<ColOp> code;
+    ColReg value, limit;
+    vector<ColReg> targets;
+    string text;                // PUT of a string or character literal, when value has no type
+    bool newline = false;
+    vector<ColStmt> arms;       // IF and ELSIF arms, each with its condition and body
+    vector<ColStmt> body;
+};
+
+// A procedure in column form, its declarations first
+struct ColumnarProgram
+{
+    vector<ColStmt> stmts;
+    int vars[3] = {}, temps[3] = {};    // columns of each type, INT, FLOAT and BOOL, kept and temporary
+    vector<pair<ColReg, Value>> consts;
+    int depth = 0;                      // deepest nesting of IF, WHILE and FOR
+};
+
+// Translate a parsed procedure to column form. Only INT, FLOAT and BOOL variables, their operators, IF, WHILE,
+// FOR, GET and PUT have one; false, with the reason, for any other procedure, or one that may read a variable
+// before assigning it
+extern bool BuildColumnar(ProgNode* prog, ColumnarProgram& columnar, string& reason);
+
+// Run a procedure once per line of input, as RunStream does, ColumnRows records at a time, each statement
+// applied to every record it reaches before the next; IF, WHILE and FOR keep a mask of the records in each
+// branch. A record that meets a run-time error is run again on its own on prog, the same procedure compiled to
+// bytecode, so its output and error reports are exactly those of the other engines
+extern StreamStats RunColumnar(const ColumnarProgram& columnar, const CompiledProgram& prog, string_view input,
+    OutputSink& output);
+
+#endif
@@ -0,0 +1,12 @@
+// Header file for the constant folding pass in Fold.cpp
+#ifndef FOLD_H_
+#define FOLD_H_
+
+#include "ast.h"
+
+using namespace std;
+
+extern void FoldProg(ProgNode* prog);
+extern ExprNode* FoldExpr(ProgNode* prog, ExprNode* expr);
+
+#endif
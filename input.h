@@ -0,0 +1,49 @@
+// Header file for input sources: where GET statements read their values from
+#ifndef INPUT_H_
+#define INPUT_H_
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+// Whitespace-separated input words read in bulk. A source is a mapped file, a caller's memory buffer,
+// or a file descriptor or stream read through a large buffer that is refilled as words are consumed
+class InputSource
+{
+    const char* cur = nullptr;
+    const char* end = nullptr;
+    vector<char> buf;
+    int fd = -1;
+    bool ownsFd = false;
+    istream* stream = nullptr;
+    void* mapped = nullptr;
+    size_t mappedSize = 0;
+    bool eof = true;
+
+    bool Refill(const char*& start);
+    void Close();
+
+public:
+    InputSource() = default;
+    explicit InputSource(string_view text) : cur(text.data()), end(text.data() + text.size()) {}
+    explicit InputSource(int fd, size_t capacity = 1 << 16);
+    explicit InputSource(istream& in, size_t capacity = 1 << 16);
+    ~InputSource() { Close(); }
+
+    InputSource(const InputSource&) = delete;
+    InputSource& operator=(const InputSource&) = delete;
+
+    // Read from a file, mapping it when it is a regular file
+    bool Open(const string& path);
+
+    // Next whitespace-delimited word. The view stays valid until the next call; false at end of input
+    bool Next(string_view& word);
+};
+
+// Standard input
+extern InputSource StdIn;
+
+#endif
@@ -0,0 +1,73 @@
+// Header file for the interpreter context: everything one parse, compilation and run of a procedure touches
+#ifndef INTERP_H_
+#define INTERP_H_
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include "lex.h"
+#include "val.h"
+#include "ast.h"
+#include "vm.h"
+#include "input.h"
+#include "output.h"
+#include "profile.h"
+
+using namespace std;
+
+struct Interp
+{
+    // Parser: identifiers interned by the lexer, and per name ID whether it names a variable (defVar),
+    // was declared in the declarative part (Declared), its declared type and its slot (-1 for none);
+    // the procedure name, and the one-token lookahead
+    NameTable Names;
+    vector<bool> defVar;
+    vector<bool> Declared;
+    vector<Token> SymTable;
+    vector<int> VarSlots;
+    int ProcName = -1;
+    vector<int> IdsList;
+    ProgNode* CurProg = nullptr;
+    vector<int> LoopVars;
+    bool pushed_back = false;
+    LexItem pushed_token;
+    int error_count = 0;
+
+    // Tree-walking evaluator: variable values by slot, and the profiler timing statements if any
+    vector<Value> TempsResults;
+    const vector<string>* SlotNames = nullptr;
+    Profiler* Prof = nullptr;
+
+    // Storage for the string values a run creates, reset when the run ends
+    Arena Strings;
+
+    // Bytecode compiler: the chunk being emitted
+    Chunk* Out = nullptr;
+    map<string, int> ConstIndex;
+    int Top = 0;
+    vector<bool> Inited;
+
+    // Source GET reads from, and the sink PUT output and error reports go to
+    InputSource* Input = &StdIn;
+    OutputSink* Sink = &StdOut;
+};
+
+// Context used by the calling thread. Every thread starts on the shared main context, so threads
+// running programs concurrently must each install their own with InterpScope
+extern Interp MainInterp;
+extern thread_local Interp* Ctx;
+
+// Install a context on the calling thread for the lifetime of the scope
+class InterpScope
+{
+    Interp* saved;
+
+public:
+    explicit InterpScope(Interp& ctx) : saved(Ctx) { Ctx = &ctx; }
+    ~InterpScope() { Ctx = saved; }
+    InterpScope(const InterpScope&) = delete;
+    InterpScope& operator=(const InterpScope&) = delete;
+};
+
+#endif
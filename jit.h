@@ -0,0 +1,65 @@
+// Header file for the JIT tier in Jit.cpp: bytecode compiled to x86-64 machine code once a program is hot
+#ifndef JIT_H_
+#define JIT_H_
+
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include "vm.h"
+
+using namespace std;
+
+// Machine code for the instructions of a chunk the JIT handles: typed integer, real and boolean operations,
+// moves, checks and jumps. Everything else (generic and string operations, PUT, GET) is left to the VM
+class JitCode
+{
+public:
+    // Runs the code from one instruction on the register file until it reaches an instruction left to the VM,
+    // or one whose check fails, and returns that instruction's pc for the VM to execute
+    typedef uint32_t (*Entry)(Value* regs);
+
+private:
+    void* memory = nullptr;
+    size_t size = 0;
+    vector<Entry> entries;
+
+    friend bool JitCompile(const Chunk& chunk, JitCode& code);
+
+public:
+    JitCode() {}
+    ~JitCode();
+    JitCode(const JitCode&) = delete;
+    JitCode& operator=(const JitCode&) = delete;
+
+    // Entry points by pc, null for the instructions left to the VM
+    const Entry* Entries() const { return entries.data(); }
+    size_t Bytes() const { return size; }
+};
+
+// Compile the instructions of a chunk the JIT handles. False on other processors or when there are none
+extern bool JitCompile(const Chunk& chunk, JitCode& code);
+
+// Runs of a program before it is compiled to machine code; 0 keeps every program in the VM
+extern atomic<uint64_t> JitThreshold;
+
+// Counts the runs of one program and holds its machine code once the count reaches JitThreshold.
+// Safe to share between threads; a copy starts over, cold
+class JitTier
+{
+    atomic<uint64_t> runs{0};
+    atomic<bool> tried{false};
+    atomic<JitCode*> code{nullptr};
+
+public:
+    JitTier() {}
+    JitTier(const JitTier&) {}
+    ~JitTier() { delete code.load(); }
+
+    // Count a run of chunk, compiling it when it becomes hot. The code to run it with, or null for the VM alone
+    const JitCode* Enter(const Chunk& chunk);
+
+    uint64_t Runs() const { return runs.load(memory_order_relaxed); }
+    bool Compiled() const { return code.load(memory_order_acquire) != nullptr; }
+};
+
+#endif
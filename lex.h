@@ -1,64 +1,116 @@
-// Header file defining lexical tokens
-lex.h
-#ifndef LEX_H_
-#define LEX_H_
-
-#include <string>
-#include <iostream>
-#include <map>
-using namespace std;
-
-enum Token 
-{
-	// keywords OR RESERVED WORDS
-	IF, ELSE, ELSIF, PUT, PUTLN, GET, INT, FLOAT,
-	CHAR, STRING, BOOL, PROCEDURE, TRUE, FALSE, END,
-	IS, BEGIN, THEN, CONST,
-	// identifiers
-	IDENT, 
-	// an integer, real, logical and string constants
-	ICONST, FCONST, SCONST, BCONST, CCONST, 
-	// the arithmetic operators, logic operators, relational operators
-	PLUS, MINUS, MULT, DIV, ASSOP, EQ, NEQ, EXP, CONCAT,
-	GTHAN, LTHAN, LTE, GTE, AND, OR, NOT, MOD,
-	//Delimiters
-	COMMA, SEMICOL, LPAREN, RPAREN, DOT, COLON,
-	// any error returns this token
-	ERR,
-	// when completed (EOF), return this token
-	DONE,
-};
-
-class LexItem 
-{
-	Token	token;
-	string	lexeme;
-	int	lnum;
-
-public:
-	LexItem() 
-	{
-		token = ERR;
-		lnum = -1;
-	}
-	LexItem(Token token, string lexeme, int line) 
-	{
-		this->token = token;
-		this->lexeme = lexeme;
-		this->lnum = line;
-	}
-
-	bool operator==(const Token token) const { return this->token == token; }
-	bool operator!=(const Token token) const { return this->token != token; }
-
-	Token	GetToken() const { return token; }
-	string	GetLexeme() const { return lexeme; }
-	int	GetLinenum() const { return lnum; }
-};
-
-extern ostream& operator<<(ostream& out, const LexItem& tok);
-extern LexItem id_or_kw(const string& lexeme, int linenum);
-extern LexItem getNextToken(istream& in, int& linenum);
-extern const map<string, Token> keywords;
-
+// Header file defining lexical tokens
+#ifndef LEX_H_
+#define LEX_H_
+
+#include <string>
+#include <string_view>
+#include <iostream>
+#include <map>
+#include <vector>
+#include <unordered_map>
+#include "arena.h"
+using namespace std;
+
+enum Token 
+{
+	// keywords OR RESERVED WORDS
+	IF, ELSE, ELSIF, PUT, PUTLN, GET, INT, FLOAT,
+	CHAR, STRING, BOOL, PROCEDURE, TRUE, FALSE, END,
+	IS, BEGIN, THEN, CONST, LOOP, WHILE, FOR, IN,
+	// identifiers
+	IDENT, 
+	// an integer, real, logical and string constants
+	ICONST, FCONST, SCONST, BCONST, CCONST, 
+	// the arithmetic operators, logic operators, relational operators
+	PLUS, MINUS, MULT, DIV, ASSOP, EQ, NEQ, EXP, CONCAT,
+	GTHAN, LTHAN, LTE, GTE, AND, OR, NOT, MOD,
+	//Delimiters
+	COMMA, SEMICOL, LPAREN, RPAREN, DOT, COLON,
+	// any error returns this token
+	ERR,
+	// when completed (EOF), return this token
+	DONE,
+};
+
+// Identifiers interned to dense integer IDs: each distinct spelling gets the next ID the first time it is
+// seen, so later lookups and comparisons are integer operations. Spellings are copied into the table
+class NameTable 
+{
+	unordered_map<string_view, int>	ids;
+	vector<string_view>	names;
+	Arena	text;
+
+public:
+	int	Intern(string_view name);
+	string_view	Name(int id) const { return names[id]; }
+	int	Size() const { return (int)names.size(); }
+	void	Clear();
+};
+
+// A token. The lexeme is a view into the LexBuffer it was read from and is valid while that buffer lives.
+// An identifier read from a buffer with a name table also carries its name ID; otherwise the ID is -1
+class LexItem 
+{
+	Token	token;
+	string_view	lexeme;
+	int	lnum;
+	int	id;
+
+public:
+	LexItem() 
+	{
+		token = ERR;
+		lnum = -1;
+		id = -1;
+	}
+	LexItem(Token token, string_view lexeme, int line, int id = -1) 
+	{
+		this->token = token;
+		this->lexeme = lexeme;
+		this->lnum = line;
+		this->id = id;
+	}
+
+	bool operator==(const Token token) const { return this->token == token; }
+	bool operator!=(const Token token) const { return this->token != token; }
+
+	Token	GetToken() const { return token; }
+	string_view	GetLexeme() const { return lexeme; }
+	int	GetLinenum() const { return lnum; }
+	int	GetId() const { return id; }
+};
+
+// Source text being scanned: a read-only mapping of a file, or a copy of a stream or string.
+// Tokens do not copy their lexemes, so the buffer must outlive them
+class LexBuffer 
+{
+	const char*	base;
+	size_t	size;
+	size_t	pos;
+	bool	mapped;
+	string	owned;
+	NameTable*	names;
+
+	friend LexItem getNextToken(LexBuffer& in, int& linenum);
+
+public:
+	LexBuffer() : base(nullptr), size(0), pos(0), mapped(false), names(nullptr) {}
+	explicit LexBuffer(istream& in);
+	explicit LexBuffer(string src);
+	~LexBuffer();
+
+	LexBuffer(const LexBuffer&) = delete;
+	LexBuffer& operator=(const LexBuffer&) = delete;
+
+	bool	Map(const string& path);
+	// Intern identifiers scanned from now on into table, or stop when it is null
+	void	InternInto(NameTable* table) { names = table; }
+	string_view	Text() const { return string_view(base, size); }
+};
+
+extern ostream& operator<<(ostream& out, const LexItem& tok);
+extern LexItem id_or_kw(string_view lexeme, int linenum);
+extern LexItem getNextToken(LexBuffer& in, int& linenum);
+extern const map<string, Token, less<>> keywords;
+
 #endif
\ No newline at end of file
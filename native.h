@@ -0,0 +1,35 @@
+// Header file for the native backend in Native.cpp: procedures translated to C++ and built into shared objects
+#ifndef NATIVE_H_
+#define NATIVE_H_
+
+#include <iostream>
+#include <string>
+#include "ast.h"
+
+using namespace std;
+
+// The function a built shared object exports: extern "C" bool sadal_main(), which runs the procedure on the
+// calling thread's context and returns false after a run-time error, like RunProg
+#define NATIVE_ENTRY "sadal_main"
+
+extern void EmitNative(ProgNode* prog, ostream& out);
+extern bool BuildNative(ProgNode* prog, const string& object, string& log);
+
+// A built procedure loaded into the process. It calls back into the interpreter for errors, input and
+// string values, so the host executable must export its symbols (ENABLE_EXPORTS in CMakeLists.txt)
+class NativeProgram
+{
+    void* handle = nullptr;
+    bool (*entry)() = nullptr;
+
+public:
+    NativeProgram() {}
+    ~NativeProgram();
+    NativeProgram(const NativeProgram&) = delete;
+    NativeProgram& operator=(const NativeProgram&) = delete;
+
+    bool Load(const string& object, string& error);
+    bool Run() const { return entry(); }
+};
+
+#endif
@@ -0,0 +1,160 @@
+// Header file for buffered output sinks: where PUT, PUTLN and error reports are written
+#ifndef OUTPUT_H_
+#define OUTPUT_H_
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <memory>
+#include <algorithm>
+#include "val.h"
+
+using namespace std;
+
+// Buffers output and hands it to Emit only when the buffer fills or on Flush. The buffer always has room for a
+// whole number, which is formatted in place. Subclasses decide where the text goes and must call Flush in
+// their destructor
+class OutputSink
+{
+    unique_ptr<char[]> buf;
+    size_t capacity;
+    size_t used = 0;
+
+protected:
+    virtual void Emit(const char* data, size_t n) = 0;
+
+public:
+    explicit OutputSink(size_t capacity = 1 << 16)
+        : buf(new char[max(capacity, MaxNumberText)]), capacity(max(capacity, MaxNumberText)) {}
+    virtual ~OutputSink() = default;
+    OutputSink(const OutputSink&) = delete;
+    OutputSink& operator=(const OutputSink&) = delete;
+
+    void Write(const char* data, size_t n)
+    {
+        if (n > capacity - used)
+        {
+            Flush();
+            if (n >= capacity)
+            {
+                Emit(data, n);
+                return;
+            }
+        }
+        memcpy(buf.get() + used, data, n);
+        used += n;
+    }
+
+    // Pass buffered text on to the destination
+    virtual void Flush()
+    {
+        if (used > 0)
+            Emit(buf.get(), used);
+        used = 0;
+    }
+
+    OutputSink& operator<<(char c)
+    {
+        if (used == capacity)
+            Flush();
+        buf[used++] = c;
+        return *this;
+    }
+
+    OutputSink& operator<<(string_view s)
+    {
+        Write(s.data(), s.size());
+        return *this;
+    }
+
+    OutputSink& operator<<(const char* s) { return *this << string_view(s); }
+    OutputSink& operator<<(const string& s) { return *this << string_view(s); }
+
+    OutputSink& operator<<(int v)
+    {
+        if (capacity - used < MaxNumberText)
+            Flush();
+        used = FormatInt(buf.get() + used, v) - buf.get();
+        return *this;
+    }
+
+    OutputSink& operator<<(double v)
+    {
+        if (capacity - used < MaxNumberText)
+            Flush();
+        used = FormatReal(buf.get() + used, v) - buf.get();
+        return *this;
+    }
+
+    // A value as PUT shows it
+    OutputSink& operator<<(const Value& v)
+    {
+        if (v.IsInt()) return *this << v.GetInt();
+        if (v.IsReal()) return *this << v.GetReal();
+        if (v.IsString()) return *this << v.GetString();
+        if (v.IsChar()) return *this << v.GetChar();
+        if (v.IsBool()) return *this << (v.GetBool() ? "true" : "false");
+        return *this << "ERROR";
+    }
+};
+
+// Writes to a file descriptor with write(2)
+class FileSink : public OutputSink
+{
+    int fd;
+
+protected:
+    void Emit(const char* data, size_t n) override;
+
+public:
+    explicit FileSink(int fd, size_t capacity = 1 << 16) : OutputSink(capacity), fd(fd) {}
+    ~FileSink() override { Flush(); }
+};
+
+// Writes to a C++ stream, flushing the stream as well on Flush
+class StreamSink : public OutputSink
+{
+    ostream& out;
+
+protected:
+    void Emit(const char* data, size_t n) override;
+
+public:
+    explicit StreamSink(ostream& out, size_t capacity = 1 << 16) : OutputSink(capacity), out(out) {}
+    ~StreamSink() override { Flush(); }
+    void Flush() override;
+};
+
+// Collects output in memory
+class StringSink : public OutputSink
+{
+    string text;
+
+protected:
+    void Emit(const char* data, size_t n) override;
+
+public:
+    explicit StringSink(size_t capacity = 1 << 12) : OutputSink(capacity) {}
+    ~StringSink() override { Flush(); }
+
+    // Everything written so far
+    const string& Text()
+    {
+        Flush();
+        return text;
+    }
+
+    // Everything written so far, leaving the sink empty
+    string Take()
+    {
+        Flush();
+        string taken;
+        taken.swap(text);
+        return taken;
+    }
+};
+
+// Standard output, flushed at exit
+extern FileSink StdOut;
+
+#endif
@@ -1,35 +1,42 @@
-// Header file for defining methods structures in ParserInterp.cpp 
-parserInterp.h
-#ifndef PARSERINTERP_H_
-#define PARSERINTERP_H_
-
-#include <iostream>
-#include "lex.h"
-
-using namespace std;
-
-extern bool ProcName(istream& in, int& line);
-extern bool Prog(istream& in, int& line);
-extern bool ProcBody(istream& in, int& line);
-extern bool DeclPart(istream& in, int& line);
-extern bool DeclStmt(istream& in, int& line);
-extern bool Type(istream& in, int& line);
-extern bool StmtList(istream& in, int& line);
-extern bool Stmt(istream& in, int& line);
-extern bool PrintStmts(istream& in, int& line);
-extern bool GetStmt(istream& in, int& line);
-extern bool IfStmt(istream& in, int& line);
-extern bool AssignStmt(istream& in, int& line);
-extern bool Var(istream& in, int& line);
-extern bool Expr(istream& in, int& line);
-extern bool Relation(istream& in, int& line);
-extern bool SimpleExpr(istream& in, int& line);
-extern bool STerm(istream& in, int& line);
-extern bool Term(istream& in, int& line);
-extern bool Factor(istream& in, int& line);
-extern bool Primary(istream& in, int& line);
-extern bool Name(istream& in, int& line);
-extern bool Range(istream& in, int& line);
-
-extern int ErrCount();
-#endif
\ No newline at end of file
+// Header file for defining methods structures in ParserInterp.cpp
+#ifndef PARSERINTERP_H_
+#define PARSERINTERP_H_
+
+#include <iostream>
+#include <vector>
+#include "lex.h"
+#include "val.h"
+#include "ast.h"
+
+using namespace std;
+
+extern bool Prog(istream& in, int& line);
+extern bool Prog(LexBuffer& in, int& line);
+extern bool ParseProg(istream& in, int& line, ProgNode*& prog, LexItem* after = nullptr);
+extern bool ParseProg(LexBuffer& in, int& line, ProgNode*& prog, LexItem* after = nullptr);
+extern bool ProcBody(LexBuffer& in, int& line, ProgNode* prog);
+extern bool DeclPart(LexBuffer& in, int& line, vector<StmtNode*>& decls);
+extern bool DeclStmt(LexBuffer& in, int& line, StmtNode*& stmt);
+extern bool Type(LexBuffer& in, int& line, Token& type);
+extern bool StmtList(LexBuffer& in, int& line, vector<StmtNode*>& stmts);
+extern bool Stmt(LexBuffer& in, int& line, StmtNode*& stmt);
+extern bool PrintStmts(LexBuffer& in, int& line, StmtNode*& stmt);
+extern bool GetStmt(LexBuffer& in, int& line, StmtNode*& stmt);
+extern bool IfStmt(LexBuffer& in, int& line, StmtNode*& stmt);
+extern bool WhileStmt(LexBuffer& in, int& line, StmtNode*& stmt);
+extern bool ForStmt(LexBuffer& in, int& line, StmtNode*& stmt);
+extern bool AssignStmt(LexBuffer& in, int& line, StmtNode*& stmt);
+extern bool Var(LexBuffer& in, int& line, LexItem& idtok);
+extern bool Expr(LexBuffer& in, int& line, ExprNode*& retExpr);
+extern bool Relation(LexBuffer& in, int& line, ExprNode*& retExpr);
+extern bool SimpleExpr(LexBuffer& in, int& line, ExprNode*& retExpr);
+extern bool STerm(LexBuffer& in, int& line, ExprNode*& retExpr);
+extern bool Term(LexBuffer& in, int& line, int sign, ExprNode*& retExpr);
+extern bool Factor(LexBuffer& in, int& line, int sign, ExprNode*& retExpr);
+extern bool Primary(LexBuffer& in, int& line, int sign, ExprNode*& retExpr);
+extern bool Name(LexBuffer& in, int& line, int sign, ExprNode*& retExpr);
+extern bool Range(LexBuffer& in, int& line, ExprNode*& retExpr1, ExprNode*& retExpr2);
+
+extern void ParseError(int line, string msg);
+extern int ErrCount();
+#endif
@@ -0,0 +1,88 @@
+// Header file for the per-statement profiler of the tree-walking evaluator
+#ifndef PROFILE_H_
+#define PROFILE_H_
+
+#include <iostream>
+#include <vector>
+#include <unordered_map>
+#include <chrono>
+#include <cstdint>
+#include "ast.h"
+
+using namespace std;
+
+// Execution counts and wall-clock time per statement, plus how often each IF arm and WHILE condition
+// was taken or skipped. Total time includes nested statements; self time excludes them
+class Profiler
+{
+    struct Branch
+    {
+        uint64_t taken = 0;
+        uint64_t skipped = 0;
+    };
+
+    struct Entry
+    {
+        uint64_t count = 0;
+        uint64_t totalNs = 0;
+        uint64_t selfNs = 0;
+        vector<Branch> branches;     // one per IF/ELSIF arm, then ELSE; one for a WHILE condition
+    };
+
+    unordered_map<const StmtNode*, Entry> entries;
+    uint64_t childNs = 0;           // time spent in statements nested in the one being timed
+
+    static uint64_t Now()
+    {
+        return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    struct Row;
+    vector<Row> Rows() const;
+
+public:
+    // Times one execution of a statement from construction to destruction
+    class Timer
+    {
+        Profiler& prof;
+        Entry& entry;
+        uint64_t savedChild;
+        uint64_t start;
+
+    public:
+        Timer(Profiler& prof, const StmtNode* stmt)
+            : prof(prof), entry(prof.entries[stmt]), savedChild(prof.childNs), start(Now())
+        {
+            prof.childNs = 0;
+        }
+
+        ~Timer()
+        {
+            uint64_t elapsed = Now() - start;
+            entry.count++;
+            entry.totalNs += elapsed;
+            entry.selfNs += elapsed - prof.childNs;
+            prof.childNs = savedChild + elapsed;
+        }
+
+        Timer(const Timer&) = delete;
+        Timer& operator=(const Timer&) = delete;
+    };
+
+    // Record whether arm (or the WHILE condition, arm 0) of a statement was taken
+    void Outcome(const StmtNode* stmt, size_t arm, bool taken)
+    {
+        vector<Branch>& branches = entries[stmt].branches;
+        if (branches.size() <= arm)
+            branches.resize(arm + 1);
+        (taken ? branches[arm].taken : branches[arm].skipped)++;
+    }
+
+    // Statements merged per source line and kind, hottest self time first
+    void Report(ostream& out) const;
+    void WriteJson(ostream& out) const;
+    uint64_t Executed() const;
+    void Clear() { entries.clear(); childNs = 0; }
+};
+
+#endif
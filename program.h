@@ -0,0 +1,130 @@
+// Header file for the embedding API: compile a procedure once, run it many times
+#ifndef PROGRAM_H_
+#define PROGRAM_H_
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <memory>
+#include <list>
+#include <unordered_map>
+#include <vector>
+#include <mutex>
+#include <cstdint>
+#include "vm.h"
+#include "jit.h"
+#include "input.h"
+#include "output.h"
+
+using namespace std;
+
+// A procedure compiled to bytecode. Holds no reference to its source or syntax tree. Runs through Run and
+// RunBatch are counted, and once JitThreshold of them have run the chunk is also compiled to machine code
+struct CompiledProgram
+{
+    bool ok = false;
+    int errors = 0;
+    string diagnostics;
+    Chunk chunk;
+    mutable JitTier tier;
+};
+
+// Parse and compile source text. On failure ok is false and diagnostics holds the error report
+extern CompiledProgram Compile(string_view source);
+
+// Execute a compiled program with GET reading from input and PUT/PUTLN and run-time errors writing to output.
+// Output is flushed when the program ends
+extern bool Run(const CompiledProgram& prog, InputSource& input, OutputSink& output);
+extern bool Run(const CompiledProgram& prog, istream& input, ostream& output);
+
+extern uint64_t SourceHash(string_view source);
+
+// Compiled programs keyed by a hash of their source, evicting the least recently used past capacity.
+// Entries are shared, so a program stays valid for callers running it after it has been evicted.
+// Safe to use from several threads
+class ProgramCache
+{
+    struct Entry
+    {
+        string source;
+        shared_ptr<const CompiledProgram> prog;
+    };
+
+    size_t capacity;
+    list<Entry> entries;
+    unordered_multimap<uint64_t, list<Entry>::iterator> index;
+    size_t hits = 0, misses = 0;
+    mutable mutex guard;
+
+    shared_ptr<const CompiledProgram> Find(uint64_t hash, string_view source);
+
+public:
+    explicit ProgramCache(size_t capacity = 256) : capacity(capacity) {}
+
+    shared_ptr<const CompiledProgram> Get(string_view source);
+    void Clear();
+
+    size_t Size() const;
+    size_t Hits() const;
+    size_t Misses() const;
+};
+
+// Totals of a run over input records, streamed or in parallel
+struct StreamStats
+{
+    uint64_t records = 0;
+    uint64_t failed = 0;        // records whose run stopped at a run-time error
+    int errors = 0;
+};
+
+// Call each for every record of newline-delimited text: a line with any "\r" before its newline trimmed.
+// Blank lines are not records
+template <class F>
+inline void SplitRecords(string_view text, F each)
+{
+    for (size_t start = 0; start < text.size();)
+    {
+        size_t stop = text.find('\n', start);
+        if (stop == string_view::npos)
+            stop = text.size();
+        size_t len = stop - start;
+        if (len > 0 && text[start + len - 1] == '\r')
+            len--;
+        if (len > 0)
+            each(text.substr(start, len));
+        start = stop + 1;
+    }
+}
+
+// Run a compiled program once per line of a newline-delimited input stream, until it ends. Each record's
+// whitespace-separated fields are what its GET statements read, and its PUT output and run-time errors go to
+// output in record order; a record that fails does not stop the stream. Blank lines are skipped. A reader
+// thread splits the input into records while the calling thread runs them, through a fixed number of
+// recycled blocks, so memory stays bounded by those blocks and the longest line however long the stream is
+extern StreamStats RunStream(const CompiledProgram& prog, int fd, OutputSink& output);
+extern StreamStats RunStream(const CompiledProgram& prog, istream& input, ostream& output);
+
+// Run a compiled program once per line of input, as RunStream does, with the records shared out among workers
+// threads (0 for one per core). Each worker has a context and variable slots of its own, and the output and
+// errors of every record are written to output in input order
+extern StreamStats RunParallel(const CompiledProgram& prog, string_view input, OutputSink& output, unsigned workers = 0);
+
+// One program run for the batch runner: source text and everything GET will read
+struct BatchJob
+{
+    string source;
+    string input;
+};
+
+// Output of one job: PUT output and run-time errors, or the parse errors if it did not compile
+struct BatchResult
+{
+    bool ok = false;
+    int errors = 0;
+    string output;
+};
+
+// Run independent programs concurrently on workers threads (0 for one per core); results are in job order
+extern vector<BatchResult> RunBatch(const vector<BatchJob>& jobs, unsigned workers = 0, ProgramCache* cache = nullptr);
+
+#endif
@@ -0,0 +1,24 @@
+# Run one sample program through the driver and compare what it prints with the expected output.
+# SADAL is the driver, ENGINE its flags, PROGRAM the source and EXPECTED the output; INPUT, when it exists,
+# is what GET reads
+separate_arguments(flags UNIX_COMMAND "${ENGINE}")
+if(NOT EXISTS "${INPUT}")
+    set(INPUT /dev/null)
+endif()
+
+execute_process(COMMAND "${SADAL}" ${flags} "${PROGRAM}"
+    INPUT_FILE "${INPUT}"
+    OUTPUT_VARIABLE actual
+    RESULT_VARIABLE result)
+
+# A program that meets a run-time error exits with 1; anything else is a crash
+if(NOT result EQUAL 0 AND NOT result EQUAL 1)
+    message(FATAL_ERROR "${ENGINE} ${PROGRAM} did not finish: ${result}\n${actual}")
+endif()
+
+# The expected output is checked in with CRLF line endings, as every file is; the driver prints LF
+file(READ "${EXPECTED}" expected)
+string(REPLACE "\r\n" "\n" expected "${expected}")
+if(NOT actual STREQUAL expected)
+    message(FATAL_ERROR "${ENGINE} ${PROGRAM} printed\n${actual}\nexpected\n${expected}")
+endif()
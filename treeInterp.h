@@ -0,0 +1,38 @@
+// Header file for the tree-walking evaluator in TreeInterp.cpp
+#ifndef TREEINTERP_H_
+#define TREEINTERP_H_
+
+#include <iostream>
+#include <vector>
+#include <string_view>
+#include <charconv>
+#include "ast.h"
+
+using namespace std;
+
+extern bool RunProg(ProgNode* prog);
+extern bool ExecList(const vector<StmtNode*>& stmts);
+extern bool Exec(StmtNode* stmt);
+extern bool Eval(ExprNode* expr, Value& retVal);
+
+// Run-time checks shared with the bytecode VM
+extern bool TypeMatch(Token varType, ValType exprType);
+extern bool ReadValue(Token type, int line, Value& retVal);
+extern bool IndexString(const Value& str, const Value& index, int line, Value& retVal);
+extern bool SliceString(const Value& str, const Value& index1, const Value& index2, int line, Value& retVal);
+extern bool Negate(const Value& val, int line, Value& retVal);
+extern Value ApplyBinary(Token op, const Value& val1, const Value& val2);
+extern bool Raised(const Value& val, int line);
+
+// Parse the leading number of an input word, as stoi/stod did: an optional sign, then as much as forms a number
+template <class T>
+inline bool ParseNumber(string_view input, T& value)
+{
+    const char* first = input.data();
+    const char* last = first + input.size();
+    if (first < last && *first == '+' && first + 1 < last && first[1] != '-')
+        first++;
+    return from_chars(first, last, value).ec == errc();
+}
+
+#endif
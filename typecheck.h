@@ -0,0 +1,11 @@
+// Header file for the static typing pass in Typecheck.cpp
+#ifndef TYPECHECK_H_
+#define TYPECHECK_H_
+
+#include "ast.h"
+
+using namespace std;
+
+extern void TypeProg(ProgNode* prog);
+
+#endif
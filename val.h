@@ -1,297 +1,564 @@
-// Header file for handling values and value types
-val.h
-#ifndef VALUE_H
-#define VALUE_H
-
-#include <iostream>
-#include <string>
-#include <queue>
-#include <map>
-#include <iomanip>
-#include <stdexcept>
-#include <cmath>
-#include <sstream>
-
-using namespace std;
-
-// Value types
-enum ValType { VINT, VREAL, VSTRING, VCHAR, VBOOL, VERR };
-
-class Value 
-{
-    ValType T;
-    bool    Btemp;
-    int Itemp;
-    double   Rtemp;
-    string Stemp;
-    char Ctemp;
-    int strcurrLen;
-    int strLen;
- 
-// Constructors
-public:
-    Value() : T(VERR), Btemp(false), Itemp(0), Rtemp(0.0), Stemp(""), Ctemp(0) {}
-    Value(bool vb) : T(VBOOL), Btemp(vb), Itemp(0), Rtemp(0.0), Stemp(""), Ctemp(0) {}
-    Value(int vi) : T(VINT), Btemp(false), Itemp(vi), Rtemp(0.0), Stemp(""), Ctemp(0) {}
-    Value(double vr) : T(VREAL), Btemp(false), Itemp(0), Rtemp(vr), Stemp(""), Ctemp(0) {}
-    Value(string vs) : T(VSTRING), Btemp(false), Itemp(0), Rtemp(0.0), Stemp(vs), Ctemp(0) 
-{
-    if(vs.length() == 0)
-    {
-    strcurrLen = 0;
-    }
-    else
-    {
-    strcurrLen = vs.length();
-    strLen = strcurrLen;
-    }
-}
-// Type query and getter methods
-    Value(char vs) : T(VCHAR), Btemp(false), Itemp(0), Rtemp(0.0), Stemp(""), Ctemp(vs) {}
-   
-    ValType GetType() const { return T; }
-    bool IsErr() const { return T == VERR; }
-    bool IsString() const { return T == VSTRING; }
-    bool IsReal() const {return T == VREAL;}
-    bool IsBool() const {return T == VBOOL;}
-    bool IsInt() const { return T == VINT; }
-    bool IsChar() const {return T == VCHAR;}
-   
-    int GetInt() const { if( IsInt() ) return Itemp; throw "RUNTIME ERROR: Value not an Integer"; }
-   
-    string GetString() const { if( IsString() ) return Stemp; throw "RUNTIME ERROR: Value not a String"; }
-   
-    double GetReal() const { if( IsReal() ) return Rtemp; throw "RUNTIME ERROR: Value not an Float"; }
-   
-    bool GetBool() const {if(IsBool()) return Btemp; throw "RUNTIME ERROR: Value not a Boolean";}
-   
-    char GetChar() const {if(IsChar()) return Ctemp; throw "RUNTIME ERROR: Value not a Character";}
-   
-    void SetType(ValType type)
-{
-    T = type;
-}
-
-// Assign values with type checks
-void SetInt(int val)
-{
-    if(IsInt())
-    Itemp = val;
-    else
-    throw "RUNTIME ERROR: Value not an Integer";
-}
-
-void SetReal(double val)
-{
-    if(IsReal())
-    Rtemp = val;
-    else
-    throw "RUNTIME ERROR: Value not an Float";   
-}
-
-void SetString(string val)
-{
-    if(IsString())  
-    {
-        if(val.length() <= strLen)
-        {
-            Stemp = val;
-            strcurrLen = val.length();
-        }
-        else
-        {
-        Stemp = val.substr(0, strLen);
-        }
-    }   
-    else
-    throw "RUNTIME ERROR: Value not a String";
-}
-
-void SetBool(bool val)
-{
-    if(IsBool())
-    Btemp = val;
-    else
-    throw "RUNTIME ERROR: Value not a Boolean";
-}
-
-void SetChar(char val)
-{
-    if(IsChar())
-    Ctemp = val;
-    else
-    throw "RUNTIME ERROR: Value not a Character";
-}
-
-void SetstrLen(int len)
-{
-if(IsString())  
-    strLen = len;
-    else
-    throw "RUNTIME ERROR: Value Type not a String";
-}
-// Overloaded operators
-Value operator+(const Value& op) const;
-   
-Value operator-(const Value& op) const;
-   
-Value operator*(const Value& op) const;
-
-Value operator/(const Value& op) const;
-   
-Value operator%(const Value & op) const;
-         
-Value operator==(const Value& op) const;
-   
-Value operator!=(const Value& op) const;
-   
-Value operator>(const Value& op) const;
-
-Value operator<(const Value& op) const;
-
-Value operator<=(const Value& op) const;
-
-Value operator>=(const Value& op) const;
-
-Value operator&&(const Value& op) const;
-   
-Value operator||(const Value& op) const;
-
-Value operator!(void) const;
-
-Value Concat(const Value & op) const;
-   
-Value Exp(const Value & op) const;
-
-// Output stream operator
-friend ostream& operator<<(ostream& out, const Value& op) 
-{
-    if( op.IsInt() ) out << op.Itemp;
-    else if(op.IsBool()) out << (op.GetBool()? "true": "false");
-    else if( op.IsChar() ) out << op.Ctemp ;
-    else if( op.IsString() ) out << op.Stemp ;
-    else if( op.IsReal()) out << fixed << showpoint << setprecision(2) << op.Rtemp;
-    else if(op.IsErr()) out << "ERROR";
-    return out;
-}
-};
-
-inline Value Value::operator+(const Value& op) const 
-{
-    if (IsInt() && op.IsInt()) return Value(Itemp + op.Itemp);
-    if (IsReal() && op.IsReal()) return Value(Rtemp + op.Rtemp);
-    if (IsInt() && op.IsReal()) return Value(Itemp + op.Rtemp);
-    if (IsReal() && op.IsInt()) return Value(Rtemp + op.Itemp);
-    return Value();
-}
-
-inline Value Value::operator-(const Value& op) const 
-{
-    if (IsInt() && op.IsInt()) return Value(Itemp - op.Itemp);
-    if (IsReal() && op.IsReal()) return Value(Rtemp - op.Rtemp);
-    if (IsInt() && op.IsReal()) return Value(Itemp - op.Rtemp);
-    if (IsReal() && op.IsInt()) return Value(Rtemp - op.Itemp);
-    return Value();
-}
-
-inline Value Value::operator*(const Value& op) const 
-{
-    if (IsInt() && op.IsInt()) return Value(Itemp * op.Itemp);
-    if (IsReal() && op.IsReal()) return Value(Rtemp * op.Rtemp);
-    if (IsInt() && op.IsReal()) return Value(Itemp * op.Rtemp);
-    if (IsReal() && op.IsInt()) return Value(Rtemp * op.Itemp);
-    return Value();
-}
-
-inline Value Value::operator/(const Value& op) const 
-{
-    if ((op.IsInt() && op.Itemp == 0) || (op.IsReal() && op.Rtemp == 0.0)) return Value();
-    if (IsInt() && op.IsInt()) return Value(Itemp / op.Itemp);
-    if (IsReal() && op.IsReal()) return Value(Rtemp / op.Rtemp);
-    if (IsInt() && op.IsReal()) return Value(Itemp / op.Rtemp);
-    if (IsReal() && op.IsInt()) return Value(Rtemp / op.Itemp);
-    return Value();
-}
-
-inline Value Value::operator%(const Value& op) const 
-{
-    if (IsInt() && op.IsInt() && op.Itemp != 0) return Value(Itemp % op.Itemp);
-    return Value();
-}
-
-inline Value Value::operator==(const Value& op) const 
-{
-    if (T != op.T) return Value(false);
-    switch (T) 
-    {
-        case VINT: return Value(Itemp == op.Itemp);
-        case VREAL: return Value(Rtemp == op.Rtemp);
-        case VSTRING: return Value(Stemp == op.Stemp);
-        case VCHAR: return Value(Ctemp == op.Ctemp);
-        case VBOOL: return Value(Btemp == op.Btemp);
-        default: return Value(false);
-    }
-}
-
-inline Value Value::operator!=(const Value& op) const 
-{
-    return Value(!((*this) == op).GetBool());
-}
-
-inline Value Value::operator<(const Value& op) const 
-{
-    if (IsInt() && op.IsInt()) return Value(Itemp < op.Itemp);
-    if (IsReal() && op.IsReal()) return Value(Rtemp < op.Rtemp);
-    if (IsInt() && op.IsReal()) return Value(Itemp < op.Rtemp);
-    if (IsReal() && op.IsInt()) return Value(Rtemp < op.Itemp);
-    return Value();
-}
-
-inline Value Value::operator<=(const Value& op) const 
-{
-    return Value((*this < op).GetBool() || (*this == op).GetBool());
-}
-
-inline Value Value::operator>(const Value& op) const 
-{
-    return Value(!(*this <= op).GetBool());
-}
-
-inline Value Value::operator>=(const Value& op) const 
-{
-    return Value(!(*this < op).GetBool());
-}
-
-inline Value Value::operator&&(const Value& op) const 
-{
-    if (IsBool() && op.IsBool()) return Value(Btemp && op.Btemp);
-    return Value();
-}
-
-inline Value Value::operator||(const Value& op) const 
-{
-    if (IsBool() && op.IsBool()) return Value(Btemp || op.Btemp);
-    return Value();
-}
-
-inline Value Value::operator!() const 
-{
-    if (IsBool()) return Value(!Btemp);
-    return Value();
-}
-
-inline Value Value::Concat(const Value& op) const 
-{
-    if (IsString() && op.IsString()) return Value(Stemp + op.Stemp);
-    return Value();
-}
-
-inline Value Value::Exp(const Value& op) const 
-{
-    if (IsInt() && op.IsInt()) return Value(pow(Itemp, op.Itemp));
-    if (IsReal() && op.IsReal()) return Value(pow(Rtemp, op.Rtemp));
-    if (IsInt() && op.IsReal()) return Value(pow(Itemp, op.Rtemp));
-    if (IsReal() && op.IsInt()) return Value(pow(Rtemp, op.Itemp));
-    return Value();
-}
+// Header file for handling values and value types
+#ifndef VALUE_H
+#define VALUE_H
+
+#include <iostream>
+#include <string>
+#include <queue>
+#include <map>
+#include <iomanip>
+#include <stdexcept>
+#include <cmath>
+#include <sstream>
+#include <cstdint>
+#include <cstring>
+#include <charconv>
+#include <cassert>
+#include <atomic>
+#include <new>
+#include <string_view>
+#include "arena.h"
+
+using namespace std;
+
+// Room for the longest number FormatReal produces: a double in fixed notation with two decimals
+const size_t MaxNumberText = 320;
+
+// Write an integer in decimal to buf. Returns the end of the text
+inline char* FormatInt(char* buf, int v)
+{
+    return to_chars(buf, buf + MaxNumberText, v).ptr;
+}
+
+// Write a real to buf the way PUT shows it, fixed-point with exactly two decimals. Returns the end of the text
+inline char* FormatReal(char* buf, double v)
+{
+    return to_chars(buf, buf + MaxNumberText, v, chars_format::fixed, 2).ptr;
+}
+
+// Integer arithmetic wraps around on overflow, the same in every engine, rather than being undefined. The one
+// quotient that does not fit, INT_MIN / -1, wraps to INT_MIN, and INT_MIN MOD -1 is 0. Division and MOD
+// expect a divisor other than zero
+inline int IntAdd(int a, int b) { return (int)((unsigned)a + (unsigned)b); }
+inline int IntSub(int a, int b) { return (int)((unsigned)a - (unsigned)b); }
+inline int IntMul(int a, int b) { return (int)((unsigned)a * (unsigned)b); }
+inline int IntNeg(int a) { return (int)(0u - (unsigned)a); }
+inline int IntDiv(int a, int b) { return b == -1 ? IntNeg(a) : a / b; }
+inline int IntMod(int a, int b) { return b == -1 ? 0 : a % b; }
+
+// Pool string storage comes from while a program runs on this thread. Outside runs it is null and strings
+// live on the heap; inside, every string value created must be gone before the run's pool is reset
+extern thread_local Arena* StringPool;
+
+// Memory for a string buffer or view, from the running program's pool when there is one
+inline void* StringAlloc(size_t size, Arena*& pool)
+{
+    pool = (StringPool != nullptr && size <= Arena::MaxTake) ? StringPool : nullptr;
+    if (pool != nullptr)
+    {
+        Allocs.pooledStrings++;
+        return pool->Take(size);
+    }
+    Allocs.heapStrings++;
+    return ::operator new(size);
+}
+
+inline void StringFree(void* p, size_t size, Arena* pool)
+{
+    if (pool != nullptr)
+        pool->Give(p, size);
+    else
+        ::operator delete(p);
+}
+
+// Reference-counted character storage shared by string values. Bytes below the fill mark never change,
+// so any number of values can view ranges of one buffer. A concatenation whose left operand ends at the
+// fill mark appends in place when there is room, which makes building a string with & linear, not quadratic
+class StrBuf
+{
+    atomic<uint32_t> refs{1};
+    atomic<size_t> used;
+    size_t cap;
+    Arena* pool;
+
+    StrBuf(size_t fill, size_t capacity, Arena* pool) : used(fill), cap(capacity), pool(pool) {}
+
+public:
+    // A buffer with room for capacity bytes, holding text at the start
+    static StrBuf* Make(string_view text, size_t capacity)
+    {
+        Arena* pool;
+        void* mem = StringAlloc(sizeof(StrBuf) + capacity, pool);
+        StrBuf* buf = new (mem) StrBuf(text.size(), capacity, pool);
+        memcpy(buf->Data(), text.data(), text.size());
+        return buf;
+    }
+
+    char* Data() { return reinterpret_cast<char*>(this + 1); }
+
+    void Retain() { refs.fetch_add(1, memory_order_relaxed); }
+
+    void Drop()
+    {
+        if (refs.fetch_sub(1, memory_order_acq_rel) == 1)
+        {
+            Arena* from = pool;
+            size_t size = sizeof(StrBuf) + cap;
+            this->~StrBuf();
+            StringFree(this, size, from);
+        }
+    }
+
+    // Write text right after the first end bytes if nothing has been written there yet. Claiming the
+    // space is atomic, so values in different threads that share a buffer cannot append over each other
+    bool Append(size_t end, string_view text)
+    {
+        size_t expect = end;
+        if (end + text.size() > cap || !used.compare_exchange_strong(expect, end + text.size()))
+            return false;
+        memcpy(Data() + end, text.data(), text.size());
+        return true;
+    }
+};
+
+// One string value's view of a buffer. Copies of a value share the view; slices and appends make new ones
+struct StrRep
+{
+    atomic<uint32_t> refs{1};
+    StrBuf* buf;
+    size_t off, len;
+    Arena* pool;
+
+    StrRep(StrBuf* b, size_t o, size_t n, Arena* pool) : buf(b), off(o), len(n), pool(pool) {}
+
+    static StrRep* Make(StrBuf* b, size_t o, size_t n)
+    {
+        Arena* pool;
+        void* mem = StringAlloc(sizeof(StrRep), pool);
+        return new (mem) StrRep(b, o, n, pool);
+    }
+
+    // Release the view and its hold on the buffer
+    void Free()
+    {
+        Arena* from = pool;
+        buf->Drop();
+        this->~StrRep();
+        StringFree(this, sizeof(StrRep), from);
+    }
+
+    string_view View() const { return string_view(buf->Data() + off, len); }
+};
+
+// Install a run's string pool on the calling thread for the lifetime of the scope, then reset the pool.
+// Every value created inside must be destroyed before the scope ends
+class StringPoolScope
+{
+    Arena* saved;
+
+public:
+    explicit StringPoolScope(Arena& pool) : saved(StringPool) { StringPool = &pool; }
+    ~StringPoolScope()
+    {
+        StringPool->Reset();
+        StringPool = saved;
+    }
+    StringPoolScope(const StringPoolScope&) = delete;
+    StringPoolScope& operator=(const StringPoolScope&) = delete;
+};
+
+// Value types
+enum ValType : uint8_t { VINT, VREAL, VSTRING, VCHAR, VBOOL, VERR };
+
+// Tagged union: the type tag and maximum string length share the first 8 bytes, the payload the second 8.
+// Scalars never allocate; a string points to a shared, reference-counted view of a StrBuf
+class Value 
+{
+    ValType T;
+    int strLen;
+    union
+    {
+        bool Btemp;
+        int Itemp;
+        double Rtemp;
+        char Ctemp;
+        StrRep* Stemp;
+        const char* Etemp;
+    };
+
+    void Release()
+    {
+        if (T == VSTRING && Stemp->refs.fetch_sub(1, memory_order_acq_rel) == 1)
+            Stemp->Free();
+    }
+
+    void Retain() const
+    {
+        if (T == VSTRING)
+            Stemp->refs.fetch_add(1, memory_order_relaxed);
+    }
+
+    static StrRep* NewString(string_view text, size_t capacity)
+    {
+        return StrRep::Make(StrBuf::Make(text, capacity), 0, text.size());
+    }
+
+    static Value StringOf(StrRep* rep)
+    {
+        Value val;
+        val.T = VSTRING;
+        val.strLen = (int)rep->len;
+        val.Stemp = rep;
+        return val;
+    }
+
+    // Take the payload bits of op; a string payload must then be retained or stolen by the caller
+    void CopyBits(const Value& op)
+    {
+        T = op.T;
+        strLen = op.strLen;
+        memcpy(static_cast<void*>(&Rtemp), static_cast<const void*>(&op.Rtemp), sizeof(Rtemp));
+    }
+ 
+// Constructors
+public:
+    Value() : T(VERR), strLen(0), Etemp(nullptr) {}
+    Value(bool vb) : T(VBOOL), strLen(0), Rtemp(0.0) { Btemp = vb; }
+    Value(int vi) : T(VINT), strLen(0), Rtemp(0.0) { Itemp = vi; }
+    Value(double vr) : T(VREAL), strLen(0), Rtemp(vr) {}
+    Value(const string& vs) : T(VSTRING), strLen((int)vs.length()), Stemp(NewString(vs, vs.length())) {}
+    Value(char vs) : T(VCHAR), strLen(0), Rtemp(0.0) { Ctemp = vs; }
+
+    Value(const Value& op)
+    {
+        CopyBits(op);
+        Retain();
+    }
+
+    Value(Value&& op) noexcept
+    {
+        CopyBits(op);
+        op.T = VERR;
+    }
+
+    Value& operator=(const Value& op)
+    {
+        op.Retain();
+        Release();
+        CopyBits(op);
+        return *this;
+    }
+
+    Value& operator=(Value&& op) noexcept
+    {
+        if (this == &op)
+            return *this;
+        Release();
+        CopyBits(op);
+        op.T = VERR;
+        return *this;
+    }
+
+    ~Value() { Release(); }
+
+// Type query and getter methods
+   
+    ValType GetType() const { return T; }
+    bool IsErr() const { return T == VERR; }
+    bool IsString() const { return T == VSTRING; }
+    bool IsReal() const {return T == VREAL;}
+    bool IsBool() const {return T == VBOOL;}
+    bool IsInt() const { return T == VINT; }
+    bool IsChar() const {return T == VCHAR;}
+   
+    // Getters expect the caller to have checked the type
+    int GetInt() const { assert(IsInt()); return Itemp; }
+   
+    // The view stays valid while this value holds the string
+    string_view GetString() const { assert(IsString()); return Stemp->View(); }
+
+    // The characters pos through pos + n - 1 of a string, sharing its buffer instead of copying
+    Value Slice(size_t pos, size_t n) const
+    {
+        assert(IsString() && pos + n <= Stemp->len);
+        Stemp->buf->Retain();
+        return StringOf(StrRep::Make(Stemp->buf, Stemp->off + pos, n));
+    }
+   
+    double GetReal() const { assert(IsReal()); return Rtemp; }
+   
+    bool GetBool() const { assert(IsBool()); return Btemp; }
+   
+    char GetChar() const { assert(IsChar()); return Ctemp; }
+
+    // Operations report run-time errors by returning an error value that carries the message, instead of throwing.
+    // A plain error value (an unassigned variable, a division by zero) carries none
+    static Value Raise(const char* msg) { Value err; err.Etemp = msg; return err; }
+    const char* Raised() const { return T == VERR ? Etemp : nullptr; }
+   
+    // Unchecked access for code whose operand types were proven before the run
+    int RawInt() const { return Itemp; }
+    double RawReal() const { return Rtemp; }
+    bool RawBool() const { return Btemp; }
+    void StoreInt(int v) { Release(); T = VINT; strLen = 0; Itemp = v; }
+    void StoreReal(double v) { Release(); T = VREAL; strLen = 0; Rtemp = v; }
+    void StoreBool(bool v) { Release(); T = VBOOL; strLen = 0; Btemp = v; }
+
+    void SetType(ValType type)
+{
+    if (type == T)
+        return;
+    Release();
+    T = type;
+    if (T == VSTRING)
+    {
+        Stemp = NewString("", 0);
+        strLen = 0;
+    }
+}
+
+// Assign values with type checks. False, leaving the value unchanged, when the type does not match
+bool SetInt(int val)
+{
+    if(!IsInt())
+        return false;
+    Itemp = val;
+    return true;
+}
+
+bool SetReal(double val)
+{
+    if(!IsReal())
+        return false;
+    Rtemp = val;
+    return true;
+}
+
+bool SetString(string_view val)
+{
+    if(!IsString())
+        return false;
+    if((int)val.length() > strLen)
+    {
+    val = val.substr(0, strLen);
+    }
+    int maxLen = strLen;
+    *this = StringOf(NewString(val, val.length()));
+    strLen = maxLen;
+    return true;
+}
+
+bool SetBool(bool val)
+{
+    if(!IsBool())
+        return false;
+    Btemp = val;
+    return true;
+}
+
+bool SetChar(char val)
+{
+    if(!IsChar())
+        return false;
+    Ctemp = val;
+    return true;
+}
+
+bool SetstrLen(int len)
+{
+    if(!IsString())
+        return false;
+    strLen = len;
+    return true;
+}
+// Overloaded operators
+Value operator+(const Value& op) const;
+   
+Value operator-(const Value& op) const;
+   
+Value operator*(const Value& op) const;
+
+Value operator/(const Value& op) const;
+   
+Value operator%(const Value & op) const;
+         
+Value operator==(const Value& op) const;
+   
+Value operator!=(const Value& op) const;
+   
+Value operator>(const Value& op) const;
+
+Value operator<(const Value& op) const;
+
+Value operator<=(const Value& op) const;
+
+Value operator>=(const Value& op) const;
+
+Value operator&&(const Value& op) const;
+   
+Value operator||(const Value& op) const;
+
+Value operator!(void) const;
+
+Value Concat(const Value & op) const;
+   
+Value Exp(const Value & op) const;
+
+// Output stream operator
+friend ostream& operator<<(ostream& out, const Value& op) 
+{
+    char buf[MaxNumberText];
+    if( op.IsInt() ) out.write(buf, FormatInt(buf, op.Itemp) - buf);
+    else if(op.IsBool()) out << (op.GetBool()? "true": "false");
+    else if( op.IsChar() ) out << op.Ctemp ;
+    else if( op.IsString() ) out << op.GetString() ;
+    else if( op.IsReal()) out.write(buf, FormatReal(buf, op.Rtemp) - buf);
+    else if(op.IsErr()) out << "ERROR";
+    return out;
+}
+};
+
+inline Value Value::operator+(const Value& op) const 
+{
+    if (IsInt() && op.IsInt()) return Value(IntAdd(Itemp, op.Itemp));
+    if (IsReal() && op.IsReal()) return Value(Rtemp + op.Rtemp);
+    if (IsInt() && op.IsReal()) return Value(Itemp + op.Rtemp);
+    if (IsReal() && op.IsInt()) return Value(Rtemp + op.Itemp);
+    return Value();
+}
+
+inline Value Value::operator-(const Value& op) const 
+{
+    if (IsInt() && op.IsInt()) return Value(IntSub(Itemp, op.Itemp));
+    if (IsReal() && op.IsReal()) return Value(Rtemp - op.Rtemp);
+    if (IsInt() && op.IsReal()) return Value(Itemp - op.Rtemp);
+    if (IsReal() && op.IsInt()) return Value(Rtemp - op.Itemp);
+    return Value();
+}
+
+inline Value Value::operator*(const Value& op) const 
+{
+    if (IsInt() && op.IsInt()) return Value(IntMul(Itemp, op.Itemp));
+    if (IsReal() && op.IsReal()) return Value(Rtemp * op.Rtemp);
+    if (IsInt() && op.IsReal()) return Value(Itemp * op.Rtemp);
+    if (IsReal() && op.IsInt()) return Value(Rtemp * op.Itemp);
+    return Value();
+}
+
+inline Value Value::operator/(const Value& op) const 
+{
+    if ((op.IsInt() && op.Itemp == 0) || (op.IsReal() && op.Rtemp == 0.0)) return Value();
+    if (IsInt() && op.IsInt()) return Value(IntDiv(Itemp, op.Itemp));
+    if (IsReal() && op.IsReal()) return Value(Rtemp / op.Rtemp);
+    if (IsInt() && op.IsReal()) return Value(Itemp / op.Rtemp);
+    if (IsReal() && op.IsInt()) return Value(Rtemp / op.Itemp);
+    return Value();
+}
+
+inline Value Value::operator%(const Value& op) const 
+{
+    if (IsInt() && op.IsInt() && op.Itemp != 0) return Value(IntMod(Itemp, op.Itemp));
+    return Value();
+}
+
+inline Value Value::operator==(const Value& op) const 
+{
+    if (T != op.T) return Value(false);
+    switch (T) 
+    {
+        case VINT: return Value(Itemp == op.Itemp);
+        case VREAL: return Value(Rtemp == op.Rtemp);
+        case VSTRING: return Value(GetString() == op.GetString());
+        case VCHAR: return Value(Ctemp == op.Ctemp);
+        case VBOOL: return Value(Btemp == op.Btemp);
+        default: return Value(false);
+    }
+}
+
+inline Value Value::operator!=(const Value& op) const 
+{
+    return Value(!((*this) == op).Btemp);
+}
+
+inline Value Value::operator<(const Value& op) const 
+{
+    if (IsInt() && op.IsInt()) return Value(Itemp < op.Itemp);
+    if (IsReal() && op.IsReal()) return Value(Rtemp < op.Rtemp);
+    if (IsInt() && op.IsReal()) return Value(Itemp < op.Rtemp);
+    if (IsReal() && op.IsInt()) return Value(Rtemp < op.Itemp);
+    return Value();
+}
+
+// <=, > and >= are built on < and raise an error when it has no boolean answer
+static const char* const NotBoolean = "RUNTIME ERROR: Value not a Boolean";
+
+inline Value Value::operator<=(const Value& op) const 
+{
+    Value less = *this < op;
+    if (!less.IsBool()) return Raise(NotBoolean);
+    return Value(less.Btemp || (*this == op).Btemp);
+}
+
+inline Value Value::operator>(const Value& op) const 
+{
+    Value lessEq = *this <= op;
+    if (!lessEq.IsBool()) return lessEq;
+    return Value(!lessEq.Btemp);
+}
+
+inline Value Value::operator>=(const Value& op) const 
+{
+    Value less = *this < op;
+    if (!less.IsBool()) return Raise(NotBoolean);
+    return Value(!less.Btemp);
+}
+
+inline Value Value::operator&&(const Value& op) const 
+{
+    if (IsBool() && op.IsBool()) return Value(Btemp && op.Btemp);
+    return Value();
+}
+
+inline Value Value::operator||(const Value& op) const 
+{
+    if (IsBool() && op.IsBool()) return Value(Btemp || op.Btemp);
+    return Value();
+}
+
+inline Value Value::operator!() const 
+{
+    if (IsBool()) return Value(!Btemp);
+    return Value();
+}
+
+// Append in place when this value's view ends at its buffer's fill mark, otherwise copy both into a new
+// buffer with room to double, so the next append to the result goes in place
+inline Value Value::Concat(const Value& op) const 
+{
+    if (!IsString() || !op.IsString()) return Value();
+
+    string_view left = GetString(), right = op.GetString();
+    size_t len = left.size() + right.size();
+    StrBuf* buf = Stemp->buf;
+    if (buf->Append(Stemp->off + left.size(), right))
+    {
+        buf->Retain();
+        return StringOf(StrRep::Make(buf, Stemp->off, len));
+    }
+
+    StrRep* rep = NewString(left, 2 * len);
+    rep->buf->Append(left.size(), right);
+    rep->len = len;
+    return StringOf(rep);
+}
+
+inline Value Value::Exp(const Value& op) const 
+{
+    if (IsInt() && op.IsInt()) return Value(pow(Itemp, op.Itemp));
+    if (IsReal() && op.IsReal()) return Value(pow(Rtemp, op.Rtemp));
+    if (IsInt() && op.IsReal()) return Value(pow(Itemp, op.Rtemp));
+    if (IsReal() && op.IsInt()) return Value(pow(Rtemp, op.Itemp));
+    return Value();
+}
+static_assert(sizeof(Value) == 16, "Value must stay 16 bytes");
 #endif
\ No newline at end of file
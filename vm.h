@@ -0,0 +1,71 @@
+// Header file for the bytecode format, compiler and register VM
+#ifndef VM_H_
+#define VM_H_
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "ast.h"
+
+using namespace std;
+
+// Opcodes. Operands a, b, c are register numbers unless noted otherwise
+enum Opcode : uint8_t
+{
+    OP_MOVE,        // R[a] = R[b]
+    OP_CHKINIT,     // error if variable R[a] has not been assigned yet
+    OP_CHKSTR,      // error if R[a] is not a string (before evaluating an index)
+    OP_CHKTYPE,     // error if R[a] does not match type b (a Token); c = 1 for a declaration
+    OP_ADD, OP_SUB, OP_MUL, OP_DIV, OP_MOD, OP_EXP, OP_CONCAT,
+    OP_EQ, OP_NEQ, OP_LT, OP_LTE, OP_GT, OP_GTE,
+    OP_AND, OP_OR,  // R[a] = R[b] op R[c]
+    OP_NOT,         // R[a] = !R[b]
+    OP_NEG,         // R[a] = -R[b], numeric only
+    // Typed forms, emitted when the operand types are known: no tag checks and no error results.
+    // I = both integer, R = both real, B = both boolean; ITOR widens an integer operand of a mixed operation
+    OP_IADD, OP_ISUB, OP_IMUL, OP_IDIV, OP_IMOD,
+    OP_IEQ, OP_INEQ, OP_ILT, OP_ILTE, OP_IGT, OP_IGTE, OP_INEG,
+    OP_RADD, OP_RSUB, OP_RMUL, OP_RDIV,
+    OP_REQ, OP_RNEQ, OP_RLT, OP_RLTE, OP_RGT, OP_RGTE, OP_RNEG,
+    OP_BAND, OP_BOR, OP_BNOT,
+    OP_ITOR,        // R[a] = (real)R[b]
+    OP_INDEX,       // R[a] = R[b](R[c])
+    OP_SLICE,       // R[a] = R[b](R[c] .. R[c+1])
+    OP_PRINT,       // print R[a], newline if b
+    OP_GET,         // read input into variable R[a] of type b (a Token)
+    OP_JMP,         // pc = a
+    OP_JMPF,        // if R[a] is false pc = b; error if not boolean, c = 1 for an ELSIF, 2 for a WHILE condition
+    OP_FORPREP,     // error unless R[a] and R[b] are integers; if R[a] > R[b] pc = c
+    OP_FORLOOP,     // if R[a] < R[b] then R[a] += 1 and pc = c
+    OP_HALT
+};
+
+struct Instr
+{
+    Opcode op;
+    uint32_t a, b, c;
+};
+
+// A compiled procedure. Registers are laid out as variable slots, then constants, then temporaries
+struct Chunk
+{
+    string name;
+    vector<Instr> code;
+    vector<int> lines;
+    vector<string> varNames;
+    vector<Token> varTypes;
+    vector<Value> consts;
+    int nregs = 0;
+
+    int ConstBase() const { return (int)varNames.size(); }
+    int TempBase() const { return ConstBase() + (int)consts.size(); }
+};
+
+class JitCode;
+
+extern bool CompileProg(ProgNode* prog, Chunk& chunk);
+extern bool RunChunk(const Chunk& chunk, const JitCode* jit = nullptr);
+extern void DumpChunk(const Chunk& chunk, ostream& out);
+
+#endif